@@ -0,0 +1,105 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// AdcSampler.h
+// Namespace for ReactorBot interrupt-driven background ADC sampling.
+// RBE-2001 A17 Team 7
+
+// The ADC-complete interrupt stores each conversion, selects the
+// next registered channel, and starts the next conversion, so all
+// channels are scanned continuously without blocking the loop.
+// Completed scans alternate between two buffers. update() copies
+// the latest complete scan into frame[], which readers index by the
+// slot returned from add(). On the host the scan is done with
+// analogRead() inside update().
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace AdcSampler {
+
+	// Registered channels
+	const uint8_t MAX_CHANNELS = 16;
+	uint8_t pins[MAX_CHANNELS];
+	uint8_t numChannels = 0;
+
+	// Latest complete scan (10-bit ADC, read by controllers)
+	uint16_t frame[MAX_CHANNELS];
+
+	// Double-buffered scans (written by ISR)
+	volatile uint16_t buffers[2][MAX_CHANNELS];
+	volatile uint8_t front = 0;     // Latest complete buffer
+	volatile uint8_t channel = 0;   // Channel being converted
+	volatile uint32_t scans = 0;    // Complete scans
+
+	// Registers analog pin for sampling (call in setup).
+	// Returns slot of pin in frame[].
+	uint8_t add(uint8_t pin) {
+		pinMode(pin, INPUT);
+		pins[numChannels] = pin;
+		return numChannels++;
+	}
+
+#if defined(__AVR__)
+
+	// Selects ADC input for given slot (AVcc reference)
+	inline void select(uint8_t slot) {
+		uint8_t ch = pins[slot] - A0;
+		ADMUX = _BV(REFS0) | (ch & 0x07);
+		if(ch & 0x08) ADCSRB |= _BV(MUX5);
+		else ADCSRB &= ~_BV(MUX5);
+	}
+
+	// Starts background sampling (call after all add() calls).
+	// Waits for the first complete scan.
+	void start() {
+		channel = 0;
+		select(0);
+		ADCSRA = _BV(ADEN) | _BV(ADIE) |
+			_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0); // 125 kHz
+		ADCSRA |= _BV(ADSC);
+		while(scans == 0);
+	}
+
+	// Copies latest complete scan into frame[] (call each tick).
+	void update() {
+		noInterrupts();
+		const volatile uint16_t* b = buffers[front];
+		for(uint8_t i=0; i<numChannels; i++) frame[i] = b[i];
+		interrupts();
+	}
+
+#else
+
+	void start() {}
+
+	void update() {
+		for(uint8_t i=0; i<numChannels; i++) frame[i] = analogRead(pins[i]);
+		scans++;
+	}
+
+#endif
+}
+
+#if defined(__AVR__)
+
+// Stores conversion and starts the next one.
+ISR(ADC_vect) {
+	using namespace AdcSampler;
+	uint8_t back = front ^ 1;
+	buffers[back][channel] = ADC;
+	if(++channel == numChannels) {
+		channel = 0;
+		front = back;
+		scans++;
+	}
+	select(channel);
+	ADCSRA |= _BV(ADSC);
+}
+
+#endif
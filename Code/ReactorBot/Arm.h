@@ -8,7 +8,10 @@
 
 #pragma once
 #include "DcMotor.h"
-#include "PidController.h"
+#include "AdcSampler.h"
+#include "FixedPid.h"
+#include "SettleDetector.h"
+#include "Scheduler.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -33,16 +36,12 @@ namespace Arm {
 		PIN_REVERSE,
 		0, 0, 1); // Ignored settings
 
-	// Motor initialization (call in setup)
-	void setup() {
-		motor.setup();
-		motor.enable();
-		pinMode(PIN_ANGLE_POT, INPUT);
-	}
+	// AdcSampler slot of angle potentiometer
+	uint8_t potSlot;
 
-	// Returns arm angle (10-bit ADC)
+	// Returns arm angle from latest ADC frame (10-bit ADC)
 	int getAngle() {
-		return analogRead(PIN_ANGLE_POT);
+		return AdcSampler::frame[potSlot];
 	}
 
 	// Arm PID Setpoints
@@ -53,30 +52,212 @@ namespace Arm {
 	const int ANGLE_PICKUP = 69;
 	const int ANGLE_DROPOFF = 110;
 
+	// Angle past which a gripped rod is clear of tubes and reactors
+	// when swinging back, so the drive may start moving
+	const int ANGLE_CLEAR = 450;
+
 	// Arm Angle PID Controller
 	// Input: Potentiometer reading (10-bit ADC)
 	// Output: Motor voltage (V)
 	const float PID_KP = 0.015;
 	const float PID_KI = 0.011;
 	const float PID_KD = 0.0;
+	const float PID_ERR_MAX = 1023.0;
 	const float RESET_TIME = 0.1;
-	PidController pid(
+	FixedPid pid(
 		PID_KP,
 		PID_KI,
 		PID_KD,
 		-TERMINAL_VOLTAGE,
 		+TERMINAL_VOLTAGE,
+		PID_ERR_MAX,
+		Scheduler::CONTROL_DT,
 		RESET_TIME);
 
-	// PID rotates arm to given setoint (1 iteration)
-	// Returns true and brakes motor if arm is stable at setpoint
-	bool setAngle(int setPoint) {
-		motor.setVoltage(pid.update(setPoint - getAngle()));
-		if(pid.isStabilized(5.0, 1.0)) {
+	// Arm Settle Detector
+	// Input: Angle error (10-bit ADC) on each control tick
+	const float SETTLE_ERR = 5.0;    // Residual tolerance (ADC)
+	const float SETTLE_RATE = 200.0; // Rate tolerance (ADC/s)
+	const float SETTLE_COAST = 0.05; // Coast time (s)
+	SettleDetector settle(SETTLE_ERR, SETTLE_RATE, SETTLE_COAST);
+
+	// Arm Motor Model
+	// The gearmotor drives the pot at SPEED_PER_VOLT per volt
+	// above the voltage holding the arm against gravity, which is
+	// GRAVITY_VOLTAGE with the arm horizontal and falls off with the
+	// cosine of its angle from horizontal.
+	// These are unmeasured estimates, not robot data. To measure them:
+	// - POT_HORIZONTAL: pot reading with the arm held level, forward.
+	// - POT_PER_RAD: pot change from level to vertical, over PI/2.
+	// - GRAVITY_VOLTAGE: mean of the voltages at which the level arm
+	//   just starts to rise and just starts to fall.
+	// - SPEED_PER_VOLT: pot rate at a fixed voltage (say 4 V) through
+	//   vertical, where gravity does not load the arm.
+	const float SPEED_PER_VOLT = 40.0;  // Pot rate ((ADC/s)/V)
+	const float GRAVITY_VOLTAGE = 1.5;  // Holding voltage when horizontal (V)
+	const float POT_HORIZONTAL = 120.0; // Pot reading, arm forward horizontal (ADC)
+	const float POT_PER_RAD = 195.0;    // Pot scale (ADC/rad)
+
+	// Returns feedforward voltage for given arm angle (ADC) and pot
+	// rate (ADC/s)
+	float feedforward(float angle, float rate) {
+		return rate / SPEED_PER_VOLT + GRAVITY_VOLTAGE
+			* cos((angle - POT_HORIZONTAL) / POT_PER_RAD);
+	}
+
+	// Arm Trajectories
+	// Moves follow minimum-time trapezoidal trajectories under the
+	// rate and acceleration limits, quantized to whole control ticks.
+	// The PID corrects the residual from the trajectory and settle
+	// detection starts once it ends. Plans between named setpoints
+	// are precomputed in setup(), so every named move has a fixed
+	// duration. Moves from anywhere else are planned at their start.
+	const float RATE_MAX = 300.0;   // (ADC/s)
+	const float ACCEL_MAX = 1200.0; // (ADC/s^2)
+	const uint8_t NUM_SETPOINTS = 6;
+	const int SETPOINTS[NUM_SETPOINTS] = {
+		ANGLE_BACK, ANGLE_TUBE, ANGLE_PREP_1,
+		ANGLE_PREP_2, ANGLE_PICKUP, ANGLE_DROPOFF };
+
+	// Trajectory timing
+	struct Plan {
+		uint16_t ramp;  // Ticks accelerating (and decelerating)
+		uint16_t total; // Ticks in move
+	};
+	Plan plans[NUM_SETPOINTS][NUM_SETPOINTS];
+
+	// Returns minimum-time plan for move of given size (ADC)
+	Plan plan(float distance) {
+		const float dt = Scheduler::CONTROL_DT;
+		Plan p = { 0, 0 };
+		if(distance < 1.0) return p;
+		float rate = fmin(RATE_MAX, sqrt(distance * ACCEL_MAX));
+		p.ramp = ceil(rate / ACCEL_MAX / dt);
+		p.total = p.ramp + ceil(distance / rate / dt);
+		return p;
+	}
+
+	// Returns index of named setpoint or -1
+	int8_t setpointIndex(int angle) {
+		for(uint8_t i=0; i<NUM_SETPOINTS; i++)
+			if(SETPOINTS[i] == angle) return i;
+		return -1;
+	}
+
+	// Precomputes plans between named setpoints
+	void planSetpoints() {
+		for(uint8_t i=0; i<NUM_SETPOINTS; i++)
+			for(uint8_t j=0; j<NUM_SETPOINTS; j++)
+				plans[i][j] = plan(abs(SETPOINTS[j] - SETPOINTS[i]));
+	}
+
+	// Motor initialization (call in setup)
+	void setup() {
+		motor.setup();
+		motor.enable();
+		potSlot = AdcSampler::add(PIN_ANGLE_POT);
+		planSetpoints();
+	}
+
+	// Concurrent Arm Control
+	// The arm tracks its own target every control tick alongside the
+	// drive, and states wait on ready() only where geometry requires.
+	int target = ANGLE_BACK; // Current setpoint (10-bit ADC)
+	bool settled = false;    // True once stable at target
+	int8_t at = -1;          // Named setpoint settled at (or -1)
+
+	// Move in progress
+	bool moving = false; // Trajectory started
+	float start;         // Start angle (ADC)
+	Plan move;           // Timing
+	uint16_t tick;       // Ticks since start
+
+	// Sets arm setpoint for loop()
+	void setTarget(int setPoint) {
+		if(setPoint == target) return;
+		target = setPoint;
+		settled = false;
+		moving = false;
+	}
+
+	// Restarts move to target from present angle
+	void restart() {
+		settled = false;
+		moving = false;
+		at = -1;
+	}
+
+	// Returns true once arm has been stable at current target
+	bool ready() {
+		return settled;
+	}
+
+	// Starts trajectory to target
+	void startMove() {
+		int8_t to = setpointIndex(target);
+		if(at >= 0 && to >= 0) {
+			start = SETPOINTS[at];
+			move = plans[at][to];
+		} else {
+			start = getAngle();
+			move = plan(fabs(target - start));
+		}
+		at = -1;
+		tick = 0;
+		moving = true;
+		settle.reset();
+		pid.reset();
+	}
+
+	// Drives arm along trajectory to target (call each control tick)
+	// Once settled the motor stays braked and the PID idles, so the
+	// integrator does not wind up against the brake.
+	void loop() {
+		if(settled) return;
+		if(!moving) startMove();
+
+		// Trajectory setpoint and rate at this tick
+		const float dt = Scheduler::CONTROL_DT;
+		float sp = target, rate = 0.0;
+		if(tick < move.total) {
+			tick++;
+			float d = target - start;
+			float t = tick * dt;
+			float tr = move.ramp * dt;
+			float tt = move.total * dt;
+			float v = d / (tt - tr);
+			float a = v / tr;
+			if(t < tr) {
+				sp = start + 0.5 * a * t * t;
+				rate = a * t;
+			} else if(t < tt - tr) {
+				sp = start + 0.5 * a * tr * tr + v * (t - tr);
+				rate = v;
+			} else if(t < tt) {
+				sp = target - 0.5 * a * (tt - t) * (tt - t);
+				rate = a * (tt - t);
+			}
+		}
+
+		// Feedforward with PID on residual
+		int angle = getAngle();
+		motor.setVoltage(feedforward(sp, rate) + pid.update(sp - angle));
+
+		// Settle once trajectory is done
+		if(tick < move.total) return;
+		if(settle.updateDiff(target - angle, dt)) {
 			motor.brake();
-			return true;
-		} else
-			return false;
+			settled = true;
+			at = setpointIndex(target);
+		}
+	}
+
+	// Brakes arm while the robot is disabled (call each control tick
+	// in place of loop()). The trajectory clock stops with it, and a
+	// move in progress is re-planned from the measured angle on resume.
+	void hold() {
+		motor.brake();
+		if(!settled) restart();
 	}
 
 	// Resets all PID controllers in namespace
@@ -0,0 +1,331 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// AutoTune.h
+// Namespace for ReactorBot relay-feedback PID auto-tuning.
+// RBE-2001 A17 Team 7
+
+// Tunes the heading, yaw rate, line and arm loops in turn by relay
+// feedback. Each experiment replaces the loop's PID with a relay of
+// amplitude d and hysteresis h, which drives the loop into a limit
+// cycle. After SKIP_CYCLES cycles the peak-to-peak error 2a and the
+// period Tu are measured over MEASURE_CYCLES cycles, giving the
+// ultimate gain Ku = 4d / (pi sqrt(a^2 - h^2)). PI loops get the
+// Ziegler-Nichols gains Kp = 0.45 Ku, Ki = 1.2 Kp / Tu and the line
+// loop (P only) Kp = 0.5 Ku. Gains are clamped to GAIN_RANGE of the
+// hand-set defaults, so a noisy experiment cannot wreck a loop.
+//
+// The drive loops turn in place about the heading held at start(),
+// so tune with the line sensor over a line and room to rotate. The
+// yaw rate loop is tuned before the line loop, whose relay commands
+// angular velocity through it. The arm cycles about ANGLE_TUBE.
+// An experiment with no limit cycle within TIMEOUT_TICKS, or which
+// loses the line, keeps the loop's previous gains. New gains apply
+// at once and are saved to EEPROM, and setup() loads them on boot.
+
+#pragma once
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "FixedPid.h"
+#include "GyroDrive.h"
+#include "LineFollower.h"
+#include "Arm.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace AutoTune {
+
+	// Tuned loops in tuning order
+	enum loop_t {
+		LOOP_HEADING,
+		LOOP_RATE,
+		LOOP_LINE,
+		LOOP_ARM,
+		NUM_LOOPS
+	};
+
+	// PID gains
+	struct Gains {
+		float kp;
+		float ki;
+		float kd;
+	};
+
+	// Controllers and their hand-set gains
+	FixedPid* const PIDS[NUM_LOOPS] = {
+		&GyroDrive::anglePid,
+		&GyroDrive::velPid,
+		&LineFollower::pid,
+		&Arm::pid
+	};
+	const Gains DEFAULTS[NUM_LOOPS] = {
+		{ GyroDrive::ANGLE_KP, GyroDrive::ANGLE_KI, GyroDrive::ANGLE_KD },
+		{ GyroDrive::VEL_KP, GyroDrive::VEL_KI, GyroDrive::VEL_KD },
+		{ LineFollower::KP, LineFollower::KI, LineFollower::KD },
+		{ Arm::PID_KP, Arm::PID_KI, Arm::PID_KD }
+	};
+
+	// Relay experiment settings
+	struct Relay {
+		float amplitude;  // Relay output (loop output units)
+		float hysteresis; // Switching band (loop input units)
+		bool integral;    // Tune as PI (else P only)
+	};
+	const Relay RELAYS[NUM_LOOPS] = {
+		{ 3.0, 0.01, true },  // Heading (V, rad)
+		{ 2.0, 0.05, true },  // Yaw rate (V, rad/s)
+		{ 0.3, 0.10, false }, // Line (rad/s, cm)
+		{ 3.0, 3.0, true }    // Arm (V, ADC)
+	};
+	const uint8_t SKIP_CYCLES = 2;      // Cycles before measuring
+	const uint8_t MEASURE_CYCLES = 4;   // Cycles measured
+	const uint16_t TIMEOUT_TICKS = 2000; // Experiment limit (control ticks)
+	const uint16_t CENTER_TICKS = 400;  // Heading recovery limit (control ticks)
+	const float GAIN_RANGE = 4.0;       // Largest change from defaults (ratio)
+
+	// EEPROM record
+	const int EEPROM_ADDR = 0;
+	const uint8_t EEPROM_VERSION = 1;
+	struct Stored {
+		uint8_t version;
+		Gains gains[NUM_LOOPS];
+		uint8_t checksum; // All bytes sum to zero
+	};
+
+	// Gains in use
+	Gains gains[NUM_LOOPS];
+
+	// Experiment state
+	enum phase_t {
+		PHASE_CENTER, // Turning back to held heading
+		PHASE_RELAY   // Relay running
+	};
+	bool active = false;
+	uint8_t current;    // Loop being tuned
+	phase_t phase;
+	float h0;           // Held heading (rad)
+	bool high;          // Relay output positive
+	uint8_t switches;   // Upward relay switches
+	uint16_t ticks;     // Control ticks in phase
+	uint16_t tStart;    // Tick of first measured switch
+	float eMin, eMax;   // Error extremes while measuring
+	bool tuned;         // Any loop got new gains
+
+	// Returns sum of bytes of s
+	uint8_t checksum(const Stored& s) {
+		const uint8_t* p = (const uint8_t*)&s;
+		uint8_t sum = 0;
+		for(uint8_t i=0; i<sizeof(Stored); i++) sum += p[i];
+		return sum;
+	}
+
+	// Sets gains of loop i
+	void setGains(uint8_t i, const Gains& g) {
+		gains[i] = g;
+		PIDS[i]->setGains(g.kp, g.ki, g.kd);
+	}
+
+	// Loads gains from EEPROM if a valid record is stored (call in setup)
+	// Returns true if stored gains were loaded.
+	bool setup() {
+		for(uint8_t i=0; i<NUM_LOOPS; i++) gains[i] = DEFAULTS[i];
+		Stored s;
+		EEPROM.get(EEPROM_ADDR, s);
+		if(s.version != EEPROM_VERSION || checksum(s) != 0) return false;
+		for(uint8_t i=0; i<NUM_LOOPS; i++) setGains(i, s.gains[i]);
+		return true;
+	}
+
+	// Saves gains in use to EEPROM
+	void save() {
+		Stored s;
+		s.version = EEPROM_VERSION;
+		for(uint8_t i=0; i<NUM_LOOPS; i++) s.gains[i] = gains[i];
+		s.checksum = 0;
+		s.checksum = -checksum(s);
+		EEPROM.put(EEPROM_ADDR, s);
+	}
+
+	// Restores and saves hand-set gains
+	void restoreDefaults() {
+		for(uint8_t i=0; i<NUM_LOOPS; i++) setGains(i, DEFAULTS[i]);
+		save();
+	}
+
+	// Prints gains in use as CSV
+	void print(Print& out) {
+		for(uint8_t i=0; i<NUM_LOOPS; i++) {
+			out.print(F("gains,"));
+			out.print(i);
+			out.print(',');
+			out.print(gains[i].kp, 4);
+			out.print(',');
+			out.print(gains[i].ki, 4);
+			out.print(',');
+			out.println(gains[i].kd, 4);
+		}
+	}
+
+	// Returns x limited to GAIN_RANGE of nominal
+	float clampGain(float x, float nominal) {
+		return constrain(x, nominal / GAIN_RANGE, nominal * GAIN_RANGE);
+	}
+
+	// Returns current loop error (loop input units)
+	float error() {
+		switch(current) {
+			case LOOP_HEADING: return GyroDrive::angleError(h0);
+			case LOOP_RATE: return -ImuSampler::gZ;
+			case LOOP_LINE: return LineFollower::linePos();
+			default: return Arm::ANGLE_TUBE - Arm::getAngle();
+		}
+	}
+
+	// Applies relay output u to current loop's actuators
+	void actuate(float u) {
+		switch(current) {
+			case LOOP_HEADING:
+				MotorL::motor.setVoltage(+u);
+				MotorR::motor.setVoltage(-u);
+				break;
+			case LOOP_RATE:
+				MotorL::motor.setVoltage(-u);
+				MotorR::motor.setVoltage(+u);
+				break;
+			case LOOP_LINE:
+				GyroDrive::setVelocity(u);
+				break;
+			default:
+				Arm::motor.setVoltage(u);
+				break;
+		}
+	}
+
+	// Brakes drive and arm motors
+	void brake() {
+		MotorL::motor.brake();
+		MotorR::motor.brake();
+		Arm::motor.brake();
+	}
+
+	// Starts experiment on loop i
+	void begin(uint8_t i) {
+		current = i;
+		phase = PHASE_CENTER;
+		ticks = 0;
+		GyroDrive::resetPids();
+		LineFollower::resetPids();
+	}
+
+	// Ends experiment on current loop, computing gains if measured,
+	// and starts the next loop or finishes tuning.
+	void end(bool measured) {
+		brake();
+		Serial.print(F("tune,"));
+		Serial.print(current);
+		if(measured) {
+			const Relay& r = RELAYS[current];
+			const Gains& g0 = DEFAULTS[current];
+			float a = 0.5 * (eMax - eMin);
+			float tu = (ticks - tStart) * Scheduler::CONTROL_DT / MEASURE_CYCLES;
+			float ku = 4.0 * r.amplitude / (PI * sqrt(fmax(a * a - r.hysteresis
+				* r.hysteresis, 0.01 * a * a)));
+			Gains g = { 0.0, 0.0, 0.0 };
+			if(r.integral) {
+				g.kp = clampGain(0.45 * ku, g0.kp);
+				g.ki = clampGain(1.2 * g.kp / tu, g0.ki);
+			} else
+				g.kp = clampGain(0.5 * ku, g0.kp);
+			setGains(current, g);
+			tuned = true;
+			Serial.print(',');
+			Serial.print(ku, 4);
+			Serial.print(',');
+			Serial.print(tu, 3);
+			Serial.print(',');
+			Serial.print(g.kp, 4);
+			Serial.print(',');
+			Serial.println(g.ki, 4);
+		} else
+			Serial.println(F(",fail"));
+		if(current + 1 < NUM_LOOPS) {
+			begin(current + 1);
+			return;
+		}
+		if(tuned) save();
+		GyroDrive::resetPids();
+		LineFollower::resetPids();
+		Arm::resetPids();
+		Arm::restart();
+		active = false;
+	}
+
+	// Starts tuning all loops about the present heading
+	void start() {
+		h0 = GyroDrive::heading();
+		tuned = false;
+		active = true;
+		begin(LOOP_HEADING);
+	}
+
+	// Returns true while tuning drives the arm
+	bool ownsArm() {
+		return active && current == LOOP_ARM;
+	}
+
+	// Brakes and restarts current experiment (call each control
+	// tick in place of update() while the robot is disabled)
+	void hold() {
+		brake();
+		begin(current);
+	}
+
+	// Runs current experiment (call each control tick while active)
+	void update() {
+		ticks++;
+
+		// Turn back to held heading before drive experiments
+		if(phase == PHASE_CENTER) {
+			if(current == LOOP_ARM || GyroDrive::setAngle(h0)
+				|| ticks >= CENTER_TICKS)
+			{
+				phase = PHASE_RELAY;
+				ticks = 0;
+				switches = 0;
+				high = false;
+			}
+			return;
+		}
+
+		// Relay with hysteresis
+		const Relay& r = RELAYS[current];
+		if(current == LOOP_LINE && !LineFollower::onLine()) {
+			end(false);
+			return;
+		}
+		float e = error();
+		if(!high && e > r.hysteresis) {
+			high = true;
+			switches++;
+			if(switches == SKIP_CYCLES + 1) {
+				tStart = ticks;
+				eMin = eMax = e;
+			} else if(switches == SKIP_CYCLES + 1 + MEASURE_CYCLES) {
+				end(true);
+				return;
+			}
+		} else if(high && e < -r.hysteresis)
+			high = false;
+		actuate(high ? r.amplitude : -r.amplitude);
+
+		// Error extremes over measured cycles
+		if(switches > SKIP_CYCLES) {
+			eMin = fmin(eMin, e);
+			eMax = fmax(eMax, e);
+		}
+		if(ticks >= TIMEOUT_TICKS) end(false);
+	}
+}
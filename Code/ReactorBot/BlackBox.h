@@ -0,0 +1,143 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// BlackBox.h
+// Namespace for ReactorBot binary telemetry ring buffer.
+// RBE-2001 A17 Team 7
+
+// Keeps the last RECORDS control snapshots in a fixed RAM ring, one
+// every DIVIDER control ticks. Records are packed little-endian
+// structs in scaled integer units, so the whole ring costs under
+// 2 KB. dump() freezes the ring and service() then writes it out
+// without blocking, a few bytes per call:
+//   'B' 'B' 'X' VERSION sizeof(Record) count
+//   count records, oldest first
+//   checksum (all bytes after the magic sum to zero)
+// Recording resumes once the dump is sent. Bump VERSION whenever
+// Record changes. ReactorHost/BlackBoxDecode.cpp turns dumps into CSV.
+// Nothing else may write to the port while dumping is set, or the
+// decoder skips the corrupted dump. The owner keeps other console
+// output off the port until then.
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace BlackBox {
+
+	// Format
+	const uint8_t VERSION = 1;
+	const uint8_t MAGIC[3] = { 'B', 'B', 'X' };
+	const uint8_t HEADER_LEN = 6;
+
+	// Ring settings
+	const uint8_t RECORDS = 100; // Ring length
+	const uint8_t DIVIDER = 4;   // Control ticks per record
+
+	// Telemetry record
+	struct Record {
+		uint16_t time;    // Control tick time (ms, wraps)
+		uint8_t state;    // State machine state
+		uint8_t mode;     // Task (bits 0-1), reactor (2), enabled (3), radiation (4-5)
+		uint16_t heading; // Gyro heading (2^-16 turn)
+		int16_t gZ;       // Yaw rate (mrad/s, CCW positive)
+		int16_t line;     // Line displacement (0.01 cm, left positive)
+		int16_t angleL;   // Left wheel angle (0.01 rad, wraps)
+		int16_t angleR;   // Right wheel angle (0.01 rad, wraps)
+		uint16_t arm;     // Arm potentiometer (10-bit ADC)
+		int8_t uHeading;  // Heading PID output (0.1 V)
+		int8_t uRate;     // Yaw rate PID output (0.1 V)
+		int8_t uArm;      // Arm PID output (0.1 V)
+	} __attribute__((packed));
+
+	static_assert(sizeof(Record) == 19,
+		"BlackBox::Record layout changed, bump VERSION");
+
+	// Ring state
+	Record ring[RECORDS];
+	uint8_t head = 0;   // Next record written
+	uint8_t count = 0;  // Records held
+	uint8_t tick = 0;   // Control ticks since last record
+	bool frozen = false; // Recording paused for dump
+
+	// Dump state
+	bool dumping = false;
+	uint8_t header[HEADER_LEN];
+	uint8_t dumpHeader; // Header bytes sent
+	uint8_t dumpRec;    // Records sent
+	uint8_t dumpByte;   // Bytes of current record sent
+	uint8_t dumpSum;    // Sum of bytes sent after magic
+
+	// Returns slot to fill on this control tick, or nullptr if no
+	// record is due or the ring is frozen (call each control tick)
+	Record* next() {
+		if(frozen || ++tick < DIVIDER) return nullptr;
+		tick = 0;
+		Record* r = ring + head;
+		head = (head + 1) % RECORDS;
+		if(count < RECORDS) count++;
+		return r;
+	}
+
+	// Converts x to 16 bits, wrapping out-of-range values
+	inline int16_t wrap16(float x) {
+		return (int16_t)(uint16_t)(int32_t)x;
+	}
+
+	// Converts voltage to record units (0.1 V)
+	inline int8_t volts(float v) {
+		float d = v * 10.0;
+		if(d > 127.0) return 127;
+		if(d < -127.0) return -127;
+		return (int8_t)d;
+	}
+
+	// Freezes ring and starts dump (ignored if one is in progress)
+	void dump() {
+		if(dumping) return;
+		frozen = true;
+		memcpy(header, MAGIC, sizeof(MAGIC));
+		header[3] = VERSION;
+		header[4] = sizeof(Record);
+		header[5] = count;
+		dumpHeader = 0;
+		dumpRec = 0;
+		dumpByte = 0;
+		dumpSum = 0;
+		dumping = true;
+	}
+
+	// Writes as much of the dump as fits in the serial transmit
+	// buffer (call periodically)
+	void service(HardwareSerial& out) {
+		if(!dumping) return;
+		int room = out.availableForWrite();
+		uint8_t first = (head + RECORDS - count) % RECORDS;
+		for(; room > 0; room--) {
+			uint8_t b;
+			if(dumpHeader < HEADER_LEN) {
+				b = header[dumpHeader];
+				if(dumpHeader++ >= sizeof(MAGIC)) dumpSum += b;
+			} else if(dumpRec < count) {
+				const uint8_t* r = (const uint8_t*)
+					(ring + (first + dumpRec) % RECORDS);
+				b = r[dumpByte];
+				dumpSum += b;
+				if(++dumpByte == sizeof(Record)) {
+					dumpByte = 0;
+					dumpRec++;
+				}
+			} else {
+				out.write((uint8_t)-dumpSum);
+				dumping = false;
+				frozen = false;
+				return;
+			}
+			out.write(b);
+		}
+	}
+}
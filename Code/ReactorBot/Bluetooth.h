@@ -13,7 +13,6 @@
 #include "Arm.h"
 #include "GyroDrive.h"
 #include "LineFollower.h"
-#include "Timer.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -21,16 +20,27 @@
 
 namespace Bluetooth {
 
-	Timer timer; // Counts time between heartbeats
-	ReactorComms com(Serial3); // Reactor communication object
+	const byte TEAM_ID = 0x07; // Robot address on the field
+	ReactorComms com(Serial3, TEAM_ID); // Reactor communication object
+	int lastRadLevel = 0; // Radiation level of last alert
 
-	// Initializes Bluetooth and heartbeat (call in setup).
+	// Queues radiation alert for given level (if any).
+	void sendRadAlert(int radLevel) {
+		switch(radLevel) {
+			case 3:
+				com.sendRadAlert(RADIATION_HI); break;
+			case 2:
+				com.sendRadAlert(RADIATION_LO); break;
+			default: break;
+		}
+	}
+
+	// Initializes Bluetooth (call in setup).
 	void setup() {
 		com.init();
-		timer.tic();
 	}
 
-	// Performs ReactorBot Bluetooth actions (call in loop).
+	// Performs ReactorBot Bluetooth actions (call in comms task).
 	void loop(int radLevel) {
 
 		// Check Bluetooth messages
@@ -50,17 +60,17 @@ namespace Bluetooth {
 			Arm::resetPids();
 		}
 
-		// Send heartbeat and radiation alerts
-		if(timer.hasElapsed(1.0)) {
-			timer.tic();
-			com.sendHeartBeat();
-			switch(radLevel) {
-				case 3:
-					com.sendRadAlert(RADIATION_HI); break;
-				case 2:
-					com.sendRadAlert(RADIATION_LO); break;
-				default: break;
-			}
+		// Send radiation alert immediately on change
+		if(radLevel != lastRadLevel) {
+			lastRadLevel = radLevel;
+			sendRadAlert(radLevel);
 		}
+
+	}
+
+	// Sends heartbeat and repeats radiation alert (call at 1 Hz).
+	void heartbeat(int radLevel) {
+		com.sendHeartBeat();
+		sendRadAlert(radLevel);
 	}
 }
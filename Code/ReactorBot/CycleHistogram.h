@@ -0,0 +1,72 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// CycleHistogram.h
+// Class for fixed-bucket cycle time histograms.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Bucket 0 counts times under BUCKET_MIN us, bucket k counts times
+// in [BUCKET_MIN * 2^(k-1), BUCKET_MIN * 2^k), and the last bucket
+// counts everything longer. Counts saturate instead of wrapping.
+class CycleHistogram {
+public:
+	static const uint8_t NUM_BUCKETS = 10;
+	static const uint32_t BUCKET_MIN = 32; // (us)
+
+	// Adds one cycle time sample (us)
+	void add(uint32_t us) {
+		uint8_t b = 0;
+		uint32_t edge = BUCKET_MIN;
+		while(us >= edge && b < NUM_BUCKETS - 1) {
+			edge <<= 1;
+			b++;
+		}
+		if(counts[b] != 0xFFFF) counts[b]++;
+		if(n != 0xFFFFFFFF) n++;
+		sum += us;
+		if(us > max) max = us;
+		if(us < min) min = us;
+	}
+
+	// Clears all samples
+	void reset() {
+		for(uint8_t b=0; b<NUM_BUCKETS; b++) counts[b] = 0;
+		n = 0;
+		sum = 0;
+		max = 0;
+		min = 0xFFFFFFFF;
+	}
+
+	// Prints one line: label, count, mean, min, max, bucket counts
+	void print(Print& out, const char* label, int id) {
+		out.print(label);
+		out.print(id);
+		out.print(',');
+		out.print(n);
+		out.print(',');
+		out.print(n ? sum / n : 0);
+		out.print(',');
+		out.print(n ? min : 0);
+		out.print(',');
+		out.print(max);
+		for(uint8_t b=0; b<NUM_BUCKETS; b++) {
+			out.print(',');
+			out.print(counts[b]);
+		}
+		out.println();
+	}
+
+	uint16_t counts[NUM_BUCKETS] = {0};
+	uint32_t n = 0;   // Samples
+	uint32_t sum = 0; // Total time (us)
+	uint32_t max = 0; // Longest sample (us)
+	uint32_t min = 0xFFFFFFFF; // Shortest sample (us)
+};
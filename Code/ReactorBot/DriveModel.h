@@ -0,0 +1,184 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// DriveModel.h
+// Namespace for ReactorBot drive motor and chassis model.
+// RBE-2001 A17 Team 7
+
+// Each drive wheel is modelled as a first-order DC motor: wheel
+// speed settles to speedPerVolt x (V - staticVoltage) with time
+// constant timeConstant. voltage() inverts the model to give the
+// feedforward voltage for a wheel speed and acceleration, so the
+// drive PIDs only correct the residual. Robot yaw rate maps to a
+// wheel speed difference through the chassis geometry.
+//
+// The motor constants are identified by a voltage-step routine
+// (console 'i'). It turns the robot in place with IDENT_STEPS
+// voltage steps of alternating direction and logs each wheel's
+// speed every control tick as "ident,step,ms,volts,wL,wR". From
+// each step it takes the steady speed over the last IDENT_AVG_TICKS
+// and the time constant from the area between the response and its
+// steady value. A least-squares line through (volts, speed) gives
+// speedPerVolt and staticVoltage. The fit is printed as
+// "model,speed_per_volt,time_constant,static_voltage" and used at
+// once. Copy it into the defaults below to keep it.
+
+#pragma once
+#include "Arduino.h"
+#include "Scheduler.h"
+#include "MotorL.h"
+#include "MotorR.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace DriveModel {
+
+	// Chassis geometry (m)
+	const float WHEEL_RADIUS = 0.035; // Drive wheel radius
+	const float TRACK_WIDTH = 0.20;   // Distance between wheels
+
+	// Motor model defaults
+	// Placeholders, not identified on the robot. Run the identification
+	// routine ('i') on the field and copy the printed fit here.
+	const float SPEED_PER_VOLT = 1.5; // Steady wheel speed ((rad/s)/V)
+	const float TIME_CONSTANT = 0.05; // Wheel speed time constant (s)
+	const float STATIC_VOLTAGE = 0.0; // Voltage to start moving (V)
+
+	// Motor model in use
+	float speedPerVolt = SPEED_PER_VOLT;
+	float timeConstant = TIME_CONSTANT;
+	float staticVoltage = STATIC_VOLTAGE;
+
+	// Returns feedforward voltage for given wheel speed (rad/s) and
+	// acceleration (rad/s^2)
+	float voltage(float speed, float accel = 0.0) {
+		float v = (speed + timeConstant * accel) / speedPerVolt;
+		if(speed > 0.0) v += staticVoltage;
+		else if(speed < 0.0) v -= staticVoltage;
+		return v;
+	}
+
+	// Returns wheel speed offset of each side for given yaw rate
+	// (rad/s, right wheel faster for positive)
+	float wheelOffset(float yawRate) {
+		return 0.5 * yawRate * TRACK_WIDTH / WHEEL_RADIUS;
+	}
+
+	// Identification Settings
+	// Each voltage is stepped in both directions so the robot ends
+	// near its starting heading.
+	const uint8_t IDENT_STEPS = 8;
+	const float IDENT_VOLTS[IDENT_STEPS] = {
+		2.0, 2.0, 4.0, 4.0, 6.0, 6.0, 8.0, 8.0 }; // (V)
+	const uint16_t IDENT_STEP_TICKS = 120; // Step length (control ticks)
+	const uint16_t IDENT_REST_TICKS = 60;  // Braked between steps (control ticks)
+	const uint16_t IDENT_AVG_TICKS = 40;   // Steady speed window (control ticks)
+
+	// Identification state
+	bool identActive = false;
+	uint8_t identStep;  // Step in progress
+	uint16_t identTick; // Control ticks into step (rest first)
+	float identL, identR;   // Wheel angles at last tick (rad)
+	float identArea;        // Integral of speed over step (rad)
+	float identSteady;      // Sum of speeds over steady window (rad/s)
+	float sumV, sumS, sumVV, sumVS; // Regression sums
+	float sumTau;           // Sum of step time constants (s)
+
+	// Starts identification routine
+	void startIdent() {
+		identStep = 0;
+		identTick = 0;
+		sumV = sumS = sumVV = sumVS = sumTau = 0.0;
+		identActive = true;
+	}
+
+	// Brakes and restarts current step (call each control tick in
+	// place of updateIdent() while the robot is disabled)
+	void holdIdent() {
+		MotorL::motor.brake();
+		MotorR::motor.brake();
+		identTick = 0;
+	}
+
+	// Fits and applies model from completed steps
+	void fitIdent() {
+		float n = IDENT_STEPS;
+		float k = (n * sumVS - sumV * sumS) / (n * sumVV - sumV * sumV);
+		float b = (sumS - k * sumV) / n;
+		if(k > 0.0) {
+			speedPerVolt = k;
+			staticVoltage = fmax(-b / k, 0.0);
+			timeConstant = sumTau / n;
+		}
+		Serial.print(F("model,"));
+		Serial.print(speedPerVolt, 4);
+		Serial.print(',');
+		Serial.print(timeConstant, 4);
+		Serial.print(',');
+		Serial.println(staticVoltage, 4);
+	}
+
+	// Runs identification (call each control tick while active)
+	void updateIdent() {
+		const float dt = Scheduler::CONTROL_DT;
+		float v = IDENT_VOLTS[identStep];
+		float dir = (identStep & 1) ? -1.0 : 1.0;
+		float l = MotorL::getAngle();
+		float r = MotorR::getAngle();
+
+		// Rest braked, then start step
+		if(identTick < IDENT_REST_TICKS) {
+			MotorL::motor.brake();
+			MotorR::motor.brake();
+			identTick++;
+			identL = l;
+			identR = r;
+			identArea = 0.0;
+			identSteady = 0.0;
+			return;
+		}
+		MotorL::motor.setVoltage(+dir * v);
+		MotorR::motor.setVoltage(-dir * v);
+
+		// Wheel speeds in step direction
+		float wL = +dir * (l - identL) / dt;
+		float wR = -dir * (r - identR) / dt;
+		identL = l;
+		identR = r;
+		float w = 0.5 * (wL + wR);
+		identArea += w * dt;
+		uint16_t k = identTick - IDENT_REST_TICKS;
+		if(k >= IDENT_STEP_TICKS - IDENT_AVG_TICKS) identSteady += w;
+		Serial.print(F("ident,"));
+		Serial.print(identStep);
+		Serial.print(',');
+		Serial.print((k + 1) * (Scheduler::CONTROL_PERIOD / 1000));
+		Serial.print(',');
+		Serial.print(dir * v);
+		Serial.print(',');
+		Serial.print(wL);
+		Serial.print(',');
+		Serial.println(wR);
+		if(++identTick < IDENT_REST_TICKS + IDENT_STEP_TICKS) return;
+
+		// Steady speed and time constant of step
+		float steady = identSteady / IDENT_AVG_TICKS;
+		if(steady > 0.0)
+			sumTau += (steady * IDENT_STEP_TICKS * dt - identArea) / steady;
+		sumV += v;
+		sumS += steady;
+		sumVV += v * v;
+		sumVS += v * steady;
+
+		// Next step or fit
+		identTick = 0;
+		if(++identStep < IDENT_STEPS) return;
+		MotorL::motor.brake();
+		MotorR::motor.brake();
+		fitIdent();
+		identActive = false;
+	}
+}
@@ -18,7 +18,7 @@ public:
 		this->x = x;
 		this->y = y;
 	}
-	bool operator==(const FieldPosition& fp) {
+	bool operator==(const FieldPosition& fp) const {
 		return ((x == fp.x) && (y == fp.y));
 	}
 	int x = 0;
@@ -0,0 +1,137 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// FixedPid.h
+// Class for fixed-point discrete PID control at a known period.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Drop-in replacement for PidController on fixed-rate loops.
+// Errors are quantized to 16 bits over [-errMax, +errMax] and the
+// output is held in 32 bits with as many fraction bits as the gains
+// allow. Gains are premultiplied by the sample period dt, so each
+// update is three 16x32 multiplies and no float math apart from the
+// input and output conversions. Output is saturated to [uMin, uMax]
+// and the integrator stops accumulating into saturation. The
+// controller resets if it has not been updated for resetTime.
+class FixedPid {
+public:
+	FixedPid(
+		float kp, float ki, float kd,
+		float uMin, float uMax,
+		float errMax, float dt,
+		float resetTime = 1.0e6) {
+		this->dt = dt;
+		this->uMin = uMin;
+		this->uMax = uMax;
+		inScale = 32767.0 / errMax;
+		resetMs = (resetTime < 4.0e6) ? (uint32_t)(resetTime * 1000.0) : 0xFFFFFFFF;
+		setGains(kp, ki, kd);
+	}
+
+	// Precomputes fixed-point coefficients for given gains
+	void setGains(float kp, float ki, float kd) {
+
+		// Largest output fraction bits keeping sums within 31 bits
+		float uAbs = fmax(fabs(uMin), fabs(uMax));
+		float gain = 32768.0 * (fabs(kp) + fabs(ki) * dt + 2.0 * fabs(kd) / dt);
+		shift = 28;
+		while(shift > 0 &&
+			ldexp(gain / inScale + 2.0 * uAbs, shift) >= 2.0e9) shift--;
+
+		// Coefficients and limits in output counts
+		float scale = ldexp(1.0, shift);
+		kpq = lround(kp * scale / inScale);
+		kiq = lround(ki * dt * scale / inScale);
+		kdq = lround(kd / dt * scale / inScale);
+		uMinq = lround(uMin * scale);
+		uMaxq = lround(uMax * scale);
+		outLsb = 1.0 / scale;
+	}
+
+	// Returns controller output for given error
+	float update(float error) {
+
+		// Reset if stale
+		uint32_t t = millis();
+		if(!running || t - tLast > resetMs) {
+			running = true;
+			iq = 0;
+			e1 = quantize(error);
+		}
+		tLast = t;
+
+		// PID terms
+		int16_t e = quantize(error);
+		de = (int32_t)e - e1;
+		int32_t ki_e = kiq * e;
+		int32_t i = iq + ki_e;
+		if(i > uMaxq) i = uMaxq;
+		if(i < uMinq) i = uMinq;
+		int32_t u = kpq * e + i + kdq * de;
+
+		// Saturation and anti-windup
+		if(u > uMaxq) {
+			u = uMaxq;
+			if(ki_e > 0) i = iq;
+		} else if(u < uMinq) {
+			u = uMinq;
+			if(ki_e < 0) i = iq;
+		}
+		iq = i;
+		e1 = e;
+		uq = u;
+		return u * outLsb;
+	}
+
+	// Returns output of last update (0 after reset)
+	float output() const {
+		return uq * outLsb;
+	}
+
+	// Returns true if error and error rate are within tolerance
+	bool isStabilized(float errTol, float derTol) {
+		return running
+			&& abs(e1) < errTol * inScale
+			&& labs(de) < derTol * dt * inScale;
+	}
+
+	void reset() {
+		running = false;
+		iq = 0;
+		de = 0;
+		uq = 0;
+	}
+
+private:
+
+	// Converts error to 16-bit counts with saturation
+	int16_t quantize(float error) {
+		float e = error * inScale;
+		if(e > 32767.0) return 32767;
+		if(e < -32767.0) return -32767;
+		return (int16_t)(e + ((e < 0.0) ? -0.5 : 0.5));
+	}
+
+	float dt;
+	float uMin, uMax;
+	float inScale;   // Error counts per unit
+	float outLsb;    // Output units per count
+	uint8_t shift;   // Output fraction bits
+	int32_t kpq, kiq, kdq;
+	int32_t uMinq, uMaxq;
+	uint32_t resetMs;
+	uint32_t tLast = 0;
+	bool running = false;
+	int32_t iq = 0;  // Integrator (output counts)
+	int16_t e1 = 0;  // Previous error (counts)
+	int32_t de = 0;  // Error difference (counts)
+	int32_t uq = 0;  // Last output (counts)
+};
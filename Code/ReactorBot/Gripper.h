@@ -6,9 +6,16 @@
 // Namespace for ReactorBot gripper servo.
 // RBE-2001 A17 Team 7
 
+// The servo gives no completion signal, so ready() predicts it from
+// a motion model: the jaw slews from its modelled angle toward the
+// commanded one at the servo's loaded slew rate, then settles. With
+// USE_FEEDBACK set, the servo potentiometer wiper is sampled and
+// ready() also returns once the jaw reaches the command or stalls on
+// a rod, with the model time as the upper bound.
+
 #pragma once
 #include "Servo.h"
-#include "Timer.h"
+#include "AdcSampler.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -18,32 +25,100 @@ namespace Gripper {
 
 	// Constants
 	const uint8_t PIN_SERVO = 10; // Servo PWM pin
-	const float GRIP_TIME = 1.0;  // Time of grip (sec)
 	const int ANGLE_OPEN = 60;    // Servo control angle
 	const int ANGLE_CLOSED = 144; // Servo control angle
 
+	// Servo Motion Model
+	// SLEW_RATE is an estimate from the servo's no-load rating, not
+	// measured on the gripper. Predicted slews are stretched by
+	// SLEW_MARGIN, so a servo up to a third slower under load still
+	// finishes before ready(). A full stroke is then 0.73 s, against the
+	// fixed 1 s wait used before. To measure the rate, film a full
+	// stroke gripping a rod, or log the wiper with USE_FEEDBACK.
+	const float SLEW_RATE = 200.0; // Estimated loaded slew rate (deg/s)
+	const float SLEW_MARGIN = 1.5; // Slew time safety factor
+	const float SETTLE_TIME = 0.1; // Settling after slew (s)
+
+	// Optional Position Feedback (servo pot wiper)
+	const bool USE_FEEDBACK = false;
+	const uint8_t PIN_FEEDBACK = A14;
+	const int FEEDBACK_OPEN = 300;   // 10-bit ADC at ANGLE_OPEN
+	const int FEEDBACK_CLOSED = 700; // 10-bit ADC at ANGLE_CLOSED
+	const int FEEDBACK_TOL = 8;      // 10-bit ADC
+	const unsigned long STALL_TIME = 60; // Still after moving (ms)
+
 	Servo gripper;
-	Timer timer;
+
+	// Motion model state
+	// Jaw position is unknown at power-up, so the first move is
+	// modelled as a full stroke.
+	int command = ANGLE_CLOSED;        // Commanded angle (deg)
+	float startAngle = ANGLE_CLOSED;   // Model angle at command (deg)
+	unsigned long startTime = 0;       // Time of command (ms)
+	unsigned long moveTime = 0;        // Predicted duration (ms)
+
+	// Feedback state
+	uint8_t feedbackSlot;        // AdcSampler slot of wiper
+	int lastFeedback = 0;        // Wiper at last motion (10-bit ADC)
+	unsigned long lastMotion = 0; // Time of last motion (ms)
+	bool moved = false;          // Motion seen since command
 
 	// Initializes gripper (call in setup).
 	void setup() {
 		gripper.attach(PIN_SERVO);
+		if(USE_FEEDBACK) feedbackSlot = AdcSampler::add(PIN_FEEDBACK);
+	}
+
+	// Returns modelled jaw angle (deg)
+	float angle() {
+		float slewed = SLEW_RATE * 0.001 * (millis() - startTime);
+		float d = command - startAngle;
+		if(fabs(d) <= slewed) return command;
+		return startAngle + ((d > 0.0) ? slewed : -slewed);
+	}
+
+	// Returns wiper reading expected at given angle (10-bit ADC)
+	int feedbackAt(int a) {
+		return FEEDBACK_OPEN + (long)(a - ANGLE_OPEN) *
+			(FEEDBACK_CLOSED - FEEDBACK_OPEN) / (ANGLE_CLOSED - ANGLE_OPEN);
+	}
+
+	// Commands servo and predicts completion time.
+	void moveTo(int a) {
+		startAngle = angle();
+		command = a;
+		startTime = millis();
+		moveTime = 1000.0 * (SLEW_MARGIN * fabs(a - startAngle) / SLEW_RATE
+			+ SETTLE_TIME);
+		gripper.write(a);
+		if(USE_FEEDBACK) {
+			lastFeedback = AdcSampler::frame[feedbackSlot];
+			lastMotion = startTime;
+			moved = false;
+		}
 	}
 
 	// Opens gripper.
 	void open() {
-		gripper.write(ANGLE_OPEN);
-		timer.tic();
+		moveTo(ANGLE_OPEN);
 	}
 
 	// Closes gripper.
 	void close() {
-		gripper.write(ANGLE_CLOSED);
-		timer.tic();
+		moveTo(ANGLE_CLOSED);
 	}
 
 	// Returns true when the gripper is done gripping.
 	bool ready() {
-		return timer.hasElapsed(GRIP_TIME);
+		if(millis() - startTime >= moveTime) return true;
+		if(!USE_FEEDBACK) return false;
+		int fb = AdcSampler::frame[feedbackSlot];
+		if(abs(fb - feedbackAt(command)) <= FEEDBACK_TOL) return true;
+		if(abs(fb - lastFeedback) > FEEDBACK_TOL) {
+			lastFeedback = fb;
+			lastMotion = millis();
+			moved = true;
+		}
+		return moved && (millis() - lastMotion >= STALL_TIME);
 	}
 }
@@ -7,10 +7,14 @@
 // RBE-2001 A17 Team 7
 
 #pragma once
-#include "Bno055.h"
-#include "PidController.h"
+#include "ImuSampler.h"
+#include "FixedPid.h"
+#include "SettleDetector.h"
+#include "TrapezoidProfile.h"
+#include "Scheduler.h"
 #include "MotorL.h"
 #include "MotorR.h"
+#include "DriveModel.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -18,18 +22,17 @@
 
 namespace GyroDrive {
 
-	Bno055 imu(trb); // IMU with dot on Top Right Back of chip
 	double h0 = 0.0; // Absolute IMU heading offset
 
 	//!b Initializes IMU (call in setup)
 	void setup() {
-		imu.begin();
-		h0 = imu.heading();
+		ImuSampler::setup();
+		h0 = ImuSampler::heading;
 	}
 
-	//!b Returns robot heading (rad)
+	//!b Returns robot heading from latest IMU sample (rad)
 	float heading() {
-		return imu.heading() - h0;
+		return ImuSampler::heading - h0;
 	}
 
 	// PID controllers will reset if not used for this time
@@ -42,30 +45,62 @@ namespace GyroDrive {
 	const float ANGLE_KP = 3.0;
 	const float ANGLE_KI = 1.0;
 	const float ANGLE_KD = 0.0;
-	PidController anglePid(
+	const float ANGLE_ERR_MAX = TWO_PI;
+	FixedPid anglePid(
 		ANGLE_KP,
 		ANGLE_KI,
 		ANGLE_KD,
 		-ANGLE_VMAX,
 		+ANGLE_VMAX,
+		ANGLE_ERR_MAX,
+		Scheduler::CONTROL_DT,
 		PID_RESET_TIME);
 
-	// PID turns robot to given absolute heading (rad)
-	// If stabilized, returns true and brakes motors
-	bool setAngle(float h) {
-		float err;
-		float hc = heading();
-		if(h <= PI) {
-			if(hc <= h + PI) err = h - hc;
-			else err = h + TWO_PI - hc;
-		} else {
-			if(hc <= h - PI) err = h - TWO_PI - hc;
-			else err = h - hc;
-		}
-		float vdd = anglePid.update(err);
+	// Returns shortest turn from heading a to heading b (rad, CW positive)
+	float angleDiff(float a, float b) {
+		float d = fmod(b - a, TWO_PI);
+		if(d > PI) d -= TWO_PI;
+		else if(d < -PI) d += TWO_PI;
+		return d;
+	}
+
+	// Returns shortest turn to given absolute heading (rad, CW positive)
+	float angleError(float h) {
+		return angleDiff(heading(), h);
+	}
+
+	// Heading Settle Detector
+	// Input: Heading error (rad) and gyro rate on each new IMU sample
+	// Braked wheels stop in about a wheel time constant.
+	const float SETTLE_ERR = 0.05;   // Residual tolerance (rad)
+	const float SETTLE_RATE = 0.5;   // Rate tolerance (rad/s)
+	const float SETTLE_COAST = 0.05; // Coast time (s)
+	SettleDetector angleSettle(SETTLE_ERR, SETTLE_RATE, SETTLE_COAST);
+	float settleTarget = 0.0;        // Heading detector is tracking (rad)
+	unsigned long settleStamp = 0;   // IMU sample last fed
+	uint32_t settleMs = 0;           // Time of last setAngle() (ms)
+
+	// PID turns robot to given absolute heading (rad) with optional
+	// feedforward differential voltage (V)
+	// If settled, returns true and brakes motors
+	bool setAngle(float h, float vff = 0.0) {
+		float err = angleError(h);
+		float vdd = anglePid.update(err) + vff;
 		MotorL::motor.setVoltage(+vdd);
 		MotorR::motor.setVoltage(-vdd);
-		if(anglePid.isStabilized(0.05, 0.01)) {
+
+		// Settle detection on new target or after a pause restarts
+		uint32_t t = millis();
+		if(h != settleTarget || t - settleMs > PID_RESET_TIME * 1000.0) {
+			settleTarget = h;
+			angleSettle.reset();
+		}
+		settleMs = t;
+		if(ImuSampler::stamp != settleStamp) {
+			settleStamp = ImuSampler::stamp;
+			angleSettle.update(err, ImuSampler::gZ);
+		}
+		if(angleSettle.settled()) {
 			MotorL::motor.brake();
 			MotorR::motor.brake();
 			return true;
@@ -73,28 +108,72 @@ namespace GyroDrive {
 			return false;
 	}
 
+	// Turn Profile
+	// Turns follow a trapezoidal heading trajectory, which setAngle()
+	// tracks with drive model feedforward of the trajectory's rate and
+	// acceleration, so a turn of any size takes close to its minimum
+	// time and ends without overshoot. The limits keep the feedforward
+	// near 10 V, leaving the PID headroom below the 12 V supply.
+	const float TURN_RATE_MAX = 4.5; // (rad/s)
+	const float TURN_ACCEL = 16.0;   // (rad/s^2)
+	TrapezoidProfile turnProfile(TURN_RATE_MAX, TURN_ACCEL, Scheduler::CONTROL_DT);
+	float turnTarget = 0.0;   // Final heading (rad)
+	float turnSetpoint = 0.0; // Trajectory heading (rad)
+	float turnRate = 0.0;     // Trajectory rate (rad/s, CW positive)
+
+	// Starts profiled turn from present heading to h (rad)
+	void startTurn(float h) {
+		turnTarget = h;
+		turnSetpoint = heading();
+		turnRate = 0.0;
+		turnProfile.reset();
+	}
+
+	// Runs profiled turn (call each control tick after startTurn)
+	// Returns true and brakes motors once settled at target
+	bool turn() {
+		float remaining = angleDiff(turnSetpoint, turnTarget);
+		float w = copysign(turnProfile.update(fabs(remaining)), remaining);
+		float accel = (w - turnRate) / Scheduler::CONTROL_DT;
+		turnRate = w;
+		if(fabs(w) * Scheduler::CONTROL_DT >= fabs(remaining)) {
+			turnSetpoint = turnTarget;
+			turnRate = 0.0;
+			return setAngle(turnTarget);
+		}
+		turnSetpoint += w * Scheduler::CONTROL_DT;
+		setAngle(turnSetpoint, DriveModel::voltage(
+			DriveModel::wheelOffset(w), DriveModel::wheelOffset(accel)));
+		return false;
+	}
+
 	// Angular Velocity PID Controller
 	// Input: Robot angular velocity (rad/s)
-	// Output: Differential motor voltage (V)
+	// Output: Differential motor voltage (V) added to feedforward
 	const float VEL_VMAX = 12.0;
 	const float VEL_KP = 1.5;
-	const float VEL_KI = 30.0;
+	const float VEL_KI = 5.0;
 	const float VEL_KD = 0.0;
-	PidController velPid(
+	const float VEL_ERR_MAX = 8.0;
+	FixedPid velPid(
 		VEL_KP,
 		VEL_KI,
 		VEL_KD,
 		-VEL_VMAX,
 		+VEL_VMAX,
+		VEL_ERR_MAX,
+		Scheduler::CONTROL_DT,
 		PID_RESET_TIME);
 
-	// PID sets robot angular velocity and linear drive voltage
-	// w is target angular velocity (rad/s)
-	// v is straight line drive voltage (V)
-	void setVelocity(float w, float v = 0) {
-		float vdd = velPid.update(w - imu.gZ());
-		MotorL::motor.setVoltage(v - vdd);
-		MotorR::motor.setVoltage(v + vdd);
+	// Sets robot angular velocity and forward wheel speed with drive
+	// model feedforward, PID correcting the angular velocity
+	// w is target angular velocity (rad/s, CCW positive)
+	// s is forward wheel speed (rad/s)
+	void setVelocity(float w, float s = 0) {
+		float vdd = velPid.update(w - ImuSampler::gZ);
+		float ds = DriveModel::wheelOffset(w);
+		MotorL::motor.setVoltage(DriveModel::voltage(s - ds) - vdd);
+		MotorR::motor.setVoltage(DriveModel::voltage(s + ds) + vdd);
 	}
 
 	// Resets all PID controllers in namespace
@@ -0,0 +1,246 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// ImuSampler.h
+// Namespace for ReactorBot non-blocking BNO055 sampling.
+// RBE-2001 A17 Team 7
+
+// The BNO055 fusion output updates at 100 Hz, so one read per output
+// period is enough. poll() is called on every main loop pass and
+// steps a TWI state machine by at most one bus event without waiting,
+// starting a 4-byte burst read of the z gyro and Euler heading
+// registers (0x18-0x1B) once per period. Completed samples are
+// cached with their timestamp for the control loops. Wire owns the
+// TWI interrupt vector, so the bus is driven by polling TWINT with
+// the TWI interrupt left disabled. The Bno055 class is only used to
+// configure the chip at setup. The scale of the raw data is taken
+// from the chip's UNIT_SEL register. On the host the Bno055 stub is
+// read once per period instead.
+
+#pragma once
+#include "Arduino.h"
+#include "Bno055.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace ImuSampler {
+
+	Bno055 imu(trb); // IMU with dot on Top Right Back of chip
+
+	// Sampling period (BNO055 fusion output rate)
+	const uint32_t PERIOD = 10000; // (us)
+
+	// Latest sample (read by controllers)
+	float heading = 0.0;     // Compass heading (rad, 0 to 2*PI)
+	float gZ = 0.0;          // Angular velocity about z (rad/s, CCW positive)
+	unsigned long stamp = 0; // Time of sample (us)
+	uint32_t samples = 0;    // Completed samples
+	uint32_t errors = 0;     // Failed bus transactions
+
+	// Time of last read start (us)
+	unsigned long lastStart = 0;
+
+	// Returns age of latest sample (us)
+	unsigned long age() {
+		return micros() - stamp;
+	}
+
+#if defined(__AVR__)
+
+	// BNO055 registers
+	const uint8_t ADDRESS = 0x28;      // 7-bit I2C address
+	const uint8_t REG_GYR_Z = 0x18;    // GYR_DATA_Z_LSB, then EUL_HEADING
+	const uint8_t REG_UNIT_SEL = 0x3B; // Unit selection
+	const uint8_t UNIT_GYR_RPS = 0x02; // Gyro in rad/s (else deg/s)
+	const uint8_t UNIT_EUL_RAD = 0x04; // Euler in rad (else deg)
+	const uint8_t BURST_LEN = 4;
+
+	// Bus settings
+	const uint32_t TWI_FREQ = 400000;  // SCL (Hz)
+	// A transaction advances one bus event per loop pass, so a limit on
+	// the whole transaction would abort valid reads whenever a task runs
+	// long. The limit is instead on each event, from the command that
+	// started it to TWINT. An event is one byte (about 25 us at 400 kHz)
+	// plus any BNO055 clock stretching, and a long loop pass only delays
+	// noticing TWINT, not the event itself.
+	const uint32_t TWI_TIMEOUT = 1000; // Bus event limit (us)
+
+	// TWI status codes (TWSR & 0xF8)
+	const uint8_t TW_START = 0x08;
+	const uint8_t TW_REP_START = 0x10;
+	const uint8_t TW_MT_SLA_ACK = 0x18;
+	const uint8_t TW_MT_DATA_ACK = 0x28;
+	const uint8_t TW_MR_SLA_ACK = 0x40;
+	const uint8_t TW_MR_DATA_ACK = 0x50;
+	const uint8_t TW_MR_DATA_NACK = 0x58;
+
+	// Raw data scales (LSB per unit), set from UNIT_SEL
+	float gyrLsb = 16.0 * 180.0 / PI; // LSB per rad/s
+	float eulLsb = 16.0 * 180.0 / PI; // LSB per rad
+
+	// Transaction state
+	enum twi_t {
+		TWI_IDLE,     // No transaction
+		TWI_START,    // Start sent
+		TWI_ADDR_W,   // Address + write sent
+		TWI_REG,      // Register sent
+		TWI_RESTART,  // Repeated start sent
+		TWI_ADDR_R,   // Address + read sent
+		TWI_DATA,     // Receiving data
+	} twi = TWI_IDLE;
+	uint8_t reg;            // Register being read
+	uint8_t len;            // Bytes to read
+	uint8_t idx;            // Bytes read
+	uint8_t buf[BURST_LEN]; // Read data
+	bool done = false;      // Transaction completed
+	unsigned long lastCommand = 0; // Time of last bus command (us)
+
+	// Clears TWINT with given extra control bits (TWI interrupt off)
+	inline void twiCommand(uint8_t bits) {
+		TWCR = _BV(TWINT) | _BV(TWEN) | bits;
+		lastCommand = micros();
+	}
+
+	// Starts read of n bytes from register r
+	void startRead(uint8_t r, uint8_t n) {
+		reg = r;
+		len = n;
+		done = false;
+		lastStart = micros();
+		twiCommand(_BV(TWSTA));
+		twi = TWI_START;
+	}
+
+	// Releases the bus after a failed transaction
+	void abort() {
+		twiCommand(_BV(TWSTO));
+		twi = TWI_IDLE;
+		errors++;
+	}
+
+	// Advances transaction by one bus event if ready (non-blocking)
+	void step() {
+		if(!(TWCR & _BV(TWINT))) {
+			if(micros() - lastCommand > TWI_TIMEOUT) abort();
+			return;
+		}
+		uint8_t status = TWSR & 0xF8;
+		switch(twi) {
+			case TWI_START:
+				if(status != TW_START) return abort();
+				TWDR = ADDRESS << 1;
+				twiCommand(0);
+				twi = TWI_ADDR_W;
+				break;
+			case TWI_ADDR_W:
+				if(status != TW_MT_SLA_ACK) return abort();
+				TWDR = reg;
+				twiCommand(0);
+				twi = TWI_REG;
+				break;
+			case TWI_REG:
+				if(status != TW_MT_DATA_ACK) return abort();
+				twiCommand(_BV(TWSTA));
+				twi = TWI_RESTART;
+				break;
+			case TWI_RESTART:
+				if(status != TW_REP_START) return abort();
+				TWDR = (ADDRESS << 1) | 1;
+				twiCommand(0);
+				twi = TWI_ADDR_R;
+				break;
+			case TWI_ADDR_R:
+				if(status != TW_MR_SLA_ACK) return abort();
+				idx = 0;
+				twiCommand((len > 1) ? _BV(TWEA) : 0);
+				twi = TWI_DATA;
+				break;
+			case TWI_DATA:
+				if(status != TW_MR_DATA_ACK && status != TW_MR_DATA_NACK)
+					return abort();
+				buf[idx++] = TWDR;
+				if(idx == len) {
+					twiCommand(_BV(TWSTO));
+					twi = TWI_IDLE;
+					done = true;
+				} else
+					twiCommand((idx < len - 1) ? _BV(TWEA) : 0);
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Returns true if bus is free for a new transaction
+	inline bool idle() {
+		return twi == TWI_IDLE && !(TWCR & _BV(TWSTO));
+	}
+
+	// Converts burst read into cached sample
+	void store() {
+		int16_t rawGz = (int16_t)(buf[0] | (buf[1] << 8));
+		int16_t rawHeading = (int16_t)(buf[2] | (buf[3] << 8));
+		gZ = rawGz / gyrLsb;
+		heading = rawHeading / eulLsb;
+		stamp = micros();
+		samples++;
+	}
+
+	// Reads registers with the poller, blocking (setup only).
+	// Returns true on success.
+	bool readBlocking(uint8_t r, uint8_t n) {
+		while(!idle());
+		startRead(r, n);
+		while(twi != TWI_IDLE) step();
+		return done;
+	}
+
+	// Configures IMU and takes first sample (call in setup)
+	void setup() {
+		imu.begin();
+		TWBR = ((F_CPU / TWI_FREQ) - 16) / 2;
+		if(readBlocking(REG_UNIT_SEL, 1)) {
+			gyrLsb = (buf[0] & UNIT_GYR_RPS) ? 900.0 : 16.0 * 180.0 / PI;
+			eulLsb = (buf[0] & UNIT_EUL_RAD) ? 900.0 : 16.0 * 180.0 / PI;
+		}
+		while(!readBlocking(REG_GYR_Z, BURST_LEN));
+		store();
+	}
+
+	// Services the bus and starts reads on schedule (call every loop)
+	void poll() {
+		if(twi != TWI_IDLE) {
+			step();
+			if(done) {
+				done = false;
+				if(reg == REG_GYR_Z) store();
+			}
+		} else if(micros() - lastStart >= PERIOD && idle())
+			startRead(REG_GYR_Z, BURST_LEN);
+	}
+
+#else
+
+	// Reads IMU stub into cached sample
+	void read() {
+		lastStart = micros();
+		heading = imu.heading();
+		gZ = imu.gZ();
+		stamp = lastStart;
+		samples++;
+	}
+
+	void setup() {
+		imu.begin();
+		read();
+	}
+
+	void poll() {
+		if(micros() - lastStart >= PERIOD) read();
+	}
+
+#endif
+}
@@ -7,8 +7,10 @@
 // RBE-2001 A17 Team 7
 
 #pragma once
-#include "Qtr8.h"
+#include "AdcSampler.h"
 #include "GyroDrive.h"
+#include "TrapezoidProfile.h"
+#include "PoseEstimator.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -17,20 +19,65 @@
 namespace LineFollower {
 
 	// Line Follower Parameters
-	const float DRIVE_VOLTAGE = 4.0; // Default (V)
+	const float DRIVE_SPEED = 6.0;   // Default wheel speed (rad/s)
 	const float ANGULAR_SPEED = 1.0; // Maximum (rad/s)
 
+	// Leg Speed Profile
+	// Deceleration from SPEED_MAX to SPEED_MIN takes one intersection
+	// spacing, so multi-intersection legs start slowing at the
+	// second-to-last intersection.
+	const float SPEED_MAX = 12.0; // Cruise wheel speed (rad/s)
+	const float SPEED_MIN = 3.0;  // Start and arrival wheel speed (rad/s)
+	const float INTERSECTION_ANGLE = PoseEstimator::GRID
+		/ PoseEstimator::WHEEL_RADIUS; // Wheel angle between lines (rad)
+	const float SPEED_ACCEL = (SPEED_MAX * SPEED_MAX - SPEED_MIN * SPEED_MIN)
+		/ (2.0 * INTERSECTION_ANGLE); // (rad/s^2)
+	TrapezoidProfile profile(SPEED_MAX, SPEED_ACCEL, Scheduler::CONTROL_DT);
+
 	// QTR-8 Analog Line Sensor
+	// Sensor 0 is on the robot's left, higher readings are darker.
 	const int THRESHOLD_WHITE = 100; // 10-bit ADC value
 	const int THRESHOLD_BLACK = 700; // 10-bit ADC value
-	const uint8_t PINS[8] = { A0, A1, A2, A3, A4, A5, A6, A7 };
-	Qtr8 sensor(PINS);
+	const uint8_t NUM_SENSORS = 8;
+	const uint8_t PINS[NUM_SENSORS] = { A0, A1, A2, A3, A4, A5, A6, A7 };
+	const float SENSOR_PITCH = 0.9525; // Sensor spacing (cm)
+	uint8_t slot; // AdcSampler slot of sensor 0
 
-	// Initializes light sensor (call in setup)
+	// Registers light sensor with ADC sampler (call in setup)
 	void setup() {
-		sensor.setup();
-		sensor.setWhiteThreshold(THRESHOLD_WHITE);
-		sensor.setBlackThreshold(THRESHOLD_BLACK);
+		slot = AdcSampler::add(PINS[0]);
+		for(uint8_t i=1; i<NUM_SENSORS; i++) AdcSampler::add(PINS[i]);
+	}
+
+	// Returns line displacement from latest ADC frame (cm, left positive)
+	float linePos() {
+		const uint16_t* adc = AdcSampler::frame + slot;
+		float sum = 0.0, moment = 0.0;
+		for(uint8_t i=0; i<NUM_SENSORS; i++) {
+			int v = adc[i];
+			if(v <= THRESHOLD_WHITE) continue;
+			float w = (v >= THRESHOLD_BLACK) ? 1.0 :
+				float(v - THRESHOLD_WHITE) / (THRESHOLD_BLACK - THRESHOLD_WHITE);
+			sum += w;
+			moment += w * (3.5 - i) * SENSOR_PITCH;
+		}
+		return (sum > 0.0) ? (moment / sum) : 0.0;
+	}
+
+	// Returns true if any sensor in latest ADC frame sees the line
+	bool onLine() {
+		const uint16_t* adc = AdcSampler::frame + slot;
+		for(uint8_t i=0; i<NUM_SENSORS; i++)
+			if(adc[i] > THRESHOLD_WHITE) return true;
+		return false;
+	}
+
+	// Returns true if all sensors in latest ADC frame read black
+	bool onBlack() {
+		const uint16_t* adc = AdcSampler::frame + slot;
+		for(uint8_t i=0; i<NUM_SENSORS; i++)
+			if(adc[i] < THRESHOLD_BLACK) return false;
+		return true;
 	}
 
 	// Line Follower PID Controller
@@ -39,15 +86,24 @@ namespace LineFollower {
 	const float KP = 1.0;
 	const float KI = 0.0;
 	const float KD = 0.0;
-	PidController pid(KP, KI, KD,
+	const float ERR_MAX = 4.0;
+	FixedPid pid(KP, KI, KD,
 		-ANGULAR_SPEED,
-		+ANGULAR_SPEED);
+		+ANGULAR_SPEED,
+		ERR_MAX,
+		Scheduler::CONTROL_DT);
+
+	// Line follows forward at given wheel speed (rad/s)
+	// Default wheel speed is DRIVE_SPEED parameter
+	void drive(float s = DRIVE_SPEED) {
+		float w = pid.update(linePos());
+		GyroDrive::setVelocity(w, s);
+	}
 
-	// Line follows forward with given drive voltage
-	// Default drive voltage is DRIVE_VOLTAGE parameter
-	void drive(float v = DRIVE_VOLTAGE) {
-		float w = pid.update(sensor.linePos());
-		GyroDrive::setVelocity(w, v);
+	// Line follows forward on the speed profile to arrive at
+	// SPEED_MIN after given remaining wheel angle (rad)
+	void driveTo(float remaining) {
+		drive(profile.update(remaining, SPEED_MIN));
 	}
 
 	// Memory for racking line intersections
@@ -55,7 +111,7 @@ namespace LineFollower {
 
 	// Returns true on black line intersection (rising edge)
 	bool hitIntersection() {
-		bool blackNow = sensor.onBlack();
+		bool blackNow = onBlack();
 		bool intersect = (blackNow && !blackBefore);
 		blackBefore = blackNow;
 		return intersect;
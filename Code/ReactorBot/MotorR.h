@@ -8,6 +8,7 @@
 
 #pragma once
 #include "DcMotor.h"
+#include "QuadEncoder.h"
 
 //**************************************************************/
 // NAMESPACE DEFINITION
@@ -32,25 +33,39 @@ namespace MotorR {
 		PIN_ENABLE,
 		PIN_FORWARD,
 		PIN_REVERSE,
+		0, 0, 1); // Encoder handled below
+
+	// Encoder object
+	QuadEncoder encoder(
 		PIN_ENCODER_A,
 		PIN_ENCODER_B,
 		ENCODER_CPR);
 
-	// Encoder ISRs
-	void interruptA() { motor.interruptA(); }
-	void interruptB() { motor.interruptB(); }
+	// Encoder ISR (host only, see vectors below)
+	void interrupt() { encoder.interrupt(); }
 
 	// Motor initialization (call in setup)
 	void setup() {
 		motor.setup();
 		motor.enable();
-		attachInterrupt(
-			motor.getInterruptA(),
-			interruptA,
-			CHANGE);
-		attachInterrupt(
-			motor.getInterruptB(),
-			interruptB,
-			CHANGE);
+		encoder.setup(interrupt);
+	}
+
+	// Returns wheel angle since last zero (rad)
+	float getAngle() {
+		return encoder.getAngle();
+	}
+
+	// Zeroes wheel angle
+	void zeroAngle() {
+		encoder.zeroAngle();
 	}
 }
+
+#if defined(__AVR__)
+
+// Encoder ISRs (pins 2 and 3)
+ISR(INT4_vect) { MotorR::encoder.interrupt(); }
+ISR(INT5_vect, ISR_ALIASOF(INT4_vect));
+
+#endif
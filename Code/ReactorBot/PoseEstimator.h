@@ -0,0 +1,103 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// PoseEstimator.h
+// Namespace for ReactorBot dead-reckoning field pose estimation.
+// RBE-2001 A17 Team 7
+
+// Tracks the VTC pose continuously in field coordinates, with
+// intersection (i, j) at (i*GRID, j*GRID), x right, y up, and
+// compass heading. Travel comes from the mean of both drive encoder
+// angles and direction from the gyro heading, taken at the midpoint
+// of each step. When the line sensor crosses an intersection while
+// the robot is square to the field, the coordinate along the heading
+// is re-anchored so the sensor sits on the nearest grid line,
+// removing accumulated wheel slip.
+
+#pragma once
+#include "Arduino.h"
+#include "MotorL.h"
+#include "MotorR.h"
+#include "GyroDrive.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace PoseEstimator {
+
+	// Geometry (m)
+	const float GRID = 0.30;           // Intersection spacing
+	const float WHEEL_RADIUS = DriveModel::WHEEL_RADIUS; // Drive wheel radius
+	const float SENSOR_OFFSET = 0.086; // Line sensor ahead of VTC
+
+	// Re-anchoring limits
+	const float SQUARE_TOL = 0.15; // Heading off field axis (rad)
+	const float ANCHOR_MAX = 0.10; // Largest accepted correction (m)
+
+	// Pose estimate
+	float x = 0.0;  // VTC x (m)
+	float y = 0.0;  // VTC y (m)
+	float th = 0.0; // Compass heading (rad)
+	uint32_t anchors = 0; // Accepted re-anchors
+
+	// Wheel angles at last update (rad)
+	float lastL = 0.0;
+	float lastR = 0.0;
+
+	// Sets pose to given field position (call in setup)
+	void setup(float x0, float y0) {
+		x = x0;
+		y = y0;
+		th = GyroDrive::heading();
+		lastL = MotorL::getAngle();
+		lastR = MotorR::getAngle();
+	}
+
+	// Returns c snapped so that c + offset lies on a grid line
+	float snap(float c, float offset) {
+		return GRID * round((c + offset) / GRID) - offset;
+	}
+
+	// Integrates wheel travel and re-anchors on intersection
+	// crossings (call each control tick)
+	void update(bool crossed) {
+
+		// Dead reckoning
+		float l = MotorL::getAngle();
+		float r = MotorR::getAngle();
+		float ds = 0.5 * WHEEL_RADIUS * ((l - lastL) + (r - lastR));
+		lastL = l;
+		lastR = r;
+		float thNew = GyroDrive::heading();
+		float dth = thNew - th;
+		if(dth > PI) dth -= TWO_PI;
+		else if(dth < -PI) dth += TWO_PI;
+		x += ds * sin(th + 0.5 * dth);
+		y += ds * cos(th + 0.5 * dth);
+		th = thNew;
+
+		// Re-anchor along heading axis when square to field
+		if(!crossed) return;
+		float s = sin(th), c = cos(th);
+		float anchored;
+		if(fabs(c) < sin(SQUARE_TOL)) {
+			anchored = snap(x, SENSOR_OFFSET * s);
+			if(fabs(anchored - x) > ANCHOR_MAX) return;
+			x = anchored;
+		} else if(fabs(s) < sin(SQUARE_TOL)) {
+			anchored = snap(y, SENSOR_OFFSET * c);
+			if(fabs(anchored - y) > ANCHOR_MAX) return;
+			y = anchored;
+		} else
+			return;
+		anchors++;
+	}
+
+	// Returns distance of VTC past intersection (i, j) along given
+	// compass heading (m, negative if short of it)
+	float pastNode(int i, int j, float h) {
+		return (x - i * GRID) * sin(h) + (y - j * GRID) * cos(h);
+	}
+}
@@ -0,0 +1,155 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// QuadEncoder.h
+// Class for table-driven quadrature encoder decoding.
+// RBE-2001 A17 Team 7
+
+// Both channels must be on the same port so one port read gives a
+// consistent A/B sample. The previous and current 2-bit states
+// index a 16-entry transition table giving -1, 0 or +1 counts, so
+// every edge on either channel costs one read and one table lookup.
+// On the Mega the owner binds interrupt() directly to the INTn
+// vectors of both pins; on the host it is attached with
+// attachInterrupt().
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CONSTANT DEFINITIONS
+//**************************************************************/
+
+// Count change indexed by (previous AB << 2) | current AB
+const int8_t QUAD_TABLE[16] = {
+	 0, -1, +1,  0,
+	+1,  0,  0, -1,
+	-1,  0,  0, +1,
+	 0, +1, -1,  0,
+};
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+class QuadEncoder {
+public:
+
+	// Estimated ISR entry and exit cycles (response, vector jump,
+	// register saves and restores, reti) added to measured decode.
+	static const uint8_t ISR_OVERHEAD_CYCLES = 40;
+
+	QuadEncoder(uint8_t pinA, uint8_t pinB, float cpr) {
+		this->pinA = pinA;
+		this->pinB = pinB;
+		radPerCount = TWO_PI / cpr;
+	}
+
+	// Configures pins and enables any-edge interrupts on both.
+	// isr is attached on the host only.
+	void setup(void (*isr)()) {
+		pinMode(pinA, INPUT);
+		pinMode(pinB, INPUT);
+		port = portInputRegister(digitalPinToPort(pinA));
+		maskA = digitalPinToBitMask(pinA);
+		maskB = digitalPinToBitMask(pinB);
+		state = sample();
+#if defined(__AVR__)
+		enableInt(pinA);
+		enableInt(pinB);
+#else
+		attachInterrupt(digitalPinToInterrupt(pinA), isr, CHANGE);
+		attachInterrupt(digitalPinToInterrupt(pinB), isr, CHANGE);
+#endif
+	}
+
+	// Decodes one edge (call from encoder ISRs)
+	inline void interrupt() {
+		uint8_t s = (state << 2) | sample();
+		count += QUAD_TABLE[s];
+		state = s & 0x03;
+	}
+
+	// Returns count with interrupts briefly disabled
+	int32_t getCount() {
+		noInterrupts();
+		int32_t c = count;
+		interrupts();
+		return c;
+	}
+
+	// Returns shaft angle since last zero (rad)
+	float getAngle() {
+		return (getCount() - zero) * radPerCount;
+	}
+
+	// Sets current shaft angle to zero
+	void zeroAngle() {
+		zero = getCount();
+	}
+
+	// Returns CPU cycles of one encoder ISR (Mega only, else 0).
+	// The decode is timed by borrowing the Scheduler's Timer2 at the
+	// CPU clock with interrupts off. Its mode and count are restored
+	// and the compare match raised while timing is dropped, so the
+	// timebase only loses the few microseconds measured.
+	// ISR_OVERHEAD_CYCLES is added.
+	uint16_t measureIsrCycles() {
+#if defined(__AVR__)
+		noInterrupts();
+		uint8_t tccr2a = TCCR2A, tccr2b = TCCR2B, tcnt2 = TCNT2;
+		TCCR2A = 0;
+		TCCR2B = _BV(CS20);
+		uint8_t t0 = TCNT2;
+		uint8_t t1 = TCNT2;
+		interrupt();
+		uint8_t t2 = TCNT2;
+		TCCR2B = 0;
+		TCCR2A = tccr2a;
+		TCNT2 = tcnt2;
+		TIFR2 = _BV(OCF2A) | _BV(TOV2);
+		TCCR2B = tccr2b;
+		interrupts();
+		return (uint8_t)(t2 - t1) - (uint8_t)(t1 - t0) + ISR_OVERHEAD_CYCLES;
+#else
+		return 0;
+#endif
+	}
+
+private:
+
+	// Returns current AB state from one port read
+	inline uint8_t sample() {
+		uint8_t p = *port;
+		return ((p & maskA) ? 2 : 0) | ((p & maskB) ? 1 : 0);
+	}
+
+#if defined(__AVR__)
+	// Enables any-edge external interrupt on given Mega pin
+	static void enableInt(uint8_t pin) {
+		int8_t n;
+		switch(pin) {
+			case 21: n = 0; break;
+			case 20: n = 1; break;
+			case 19: n = 2; break;
+			case 18: n = 3; break;
+			case 2: n = 4; break;
+			case 3: n = 5; break;
+			default: return;
+		}
+		if(n < 4) EICRA = (EICRA & ~(3 << (2 * n))) | (1 << (2 * n));
+		else EICRB = (EICRB & ~(3 << (2 * (n - 4)))) | (1 << (2 * (n - 4)));
+		EIFR = _BV(n);
+		EIMSK |= _BV(n);
+	}
+#endif
+
+	uint8_t pinA, pinB;
+	volatile uint8_t* port;
+	uint8_t maskA, maskB;
+	float radPerCount;
+	volatile uint8_t state = 0;
+	volatile int32_t count = 0;
+	int32_t zero = 0;
+};
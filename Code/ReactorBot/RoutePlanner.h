@@ -0,0 +1,190 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// RoutePlanner.h
+// Namespace for ReactorBot minimum-time route planning.
+// RBE-2001 A17 Team 7
+
+// The robot can only travel along the y = 0 line between tubes and
+// reactors, so a route is a sequence of legs between intersections
+// (x, 0) with the robot's VTC on the intersection, facing one of
+// four headings. Legs are gyro turns, forward line follows, and
+// gyro-driven reverses along x (which avoid 180 degree turns), each
+// ending with the VTC on the intersection. Tube routes end facing
+// the tube, and reactor routes end with a forward line follow into
+// the reactor. setup() finds the minimum-time first leg and total
+// time from every node to every target and stores them in tables.
+
+#pragma once
+#include "Arduino.h"
+#include "FieldPosition.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace RoutePlanner {
+
+	// Headings (index * PI/2 is compass heading)
+	enum heading_t {
+		HEADING_IDX_U,
+		HEADING_IDX_R,
+		HEADING_IDX_D,
+		HEADING_IDX_L,
+	};
+
+	// Leg types
+	enum leg_t {
+		LEG_NONE,    // No route
+		LEG_DONE,    // At tube node, facing tube
+		LEG_TURN,    // Gyro turn to heading arg
+		LEG_FOLLOW,  // Line follow forward to x = arg
+		LEG_REVERSE, // Gyro drive backward to x = arg
+		LEG_ARRIVE,  // Line follow forward into reactor at x = arg
+	};
+
+	// Leg durations (tenths of a second)
+	// Hand estimates for the original 4 V line follow and gyro turns,
+	// not timed on the field. Routes and tubes are chosen by comparing
+	// sums of them, so only their relative sizes matter. Re-time them
+	// on the field when drive speeds change.
+	const uint8_t COST_TURN_90 = 15;
+	const uint8_t COST_TURN_180 = 25;
+	const uint8_t COST_FOLLOW = 15;  // Per intersection
+	const uint8_t COST_REVERSE = 20; // Per intersection
+	const uint8_t COST_BACK_TO_LINE = 15; // From tube or reactor
+
+	// Planning graph
+	const uint8_t X_MIN = 1;
+	const uint8_t X_MAX = 6;
+	const uint8_t NUM_X = X_MAX - X_MIN + 1;
+	const uint8_t NUM_NODES = NUM_X * 4;
+	const uint8_t NUM_TARGETS = 10; // Reactors, storage, supply
+	const uint8_t COST_INF = 0xFF;
+	const uint16_t TIME_INF = 0x7FFF;
+
+	// Route tables [target][node]
+	uint8_t legTable[NUM_TARGETS][NUM_NODES]; // Type << 4 | arg
+	uint8_t costTable[NUM_TARGETS][NUM_NODES];
+
+	// Returns node index of intersection x with given heading
+	inline uint8_t node(uint8_t x, uint8_t h) {
+		return (x - X_MIN) * 4 + h;
+	}
+
+	// Returns target index of field position (or -1)
+	// 0-1: Reactors A, B  2-5: Storage 1-4  6-9: Supply 1-4
+	int target(const FieldPosition& p) {
+		if(p == REACTOR_A) return 0;
+		if(p == REACTOR_B) return 1;
+		for(int i=0; i<4; i++) {
+			if(p == STORAGE[i]) return 2 + i;
+			if(p == SUPPLY[i]) return 6 + i;
+		}
+		return -1;
+	}
+
+	// Fills tables for one target by relaxing all legs until no
+	// node's time improves (Bellman-Ford on 24 nodes).
+	void plan(uint8_t t, const FieldPosition& goal) {
+		uint8_t* leg = legTable[t];
+		uint8_t* cost = costTable[t];
+		for(uint8_t n=0; n<NUM_NODES; n++) {
+			leg[n] = LEG_NONE << 4;
+			cost[n] = COST_INF;
+		}
+
+		// Terminal legs
+		if(goal.y == 0) {
+			uint8_t h = (goal.x == X_MIN) ? HEADING_IDX_L : HEADING_IDX_R;
+			for(uint8_t x=X_MIN; x<=X_MAX; x++) {
+				int dx = (h == HEADING_IDX_R) ? (goal.x - x) : (x - goal.x);
+				if(dx < 0) continue;
+				leg[node(x, h)] = (LEG_ARRIVE << 4) | goal.x;
+				cost[node(x, h)] = dx * COST_FOLLOW;
+			}
+		} else {
+			uint8_t h = (goal.y > 0) ? HEADING_IDX_U : HEADING_IDX_D;
+			leg[node(goal.x, h)] = LEG_DONE << 4;
+			cost[node(goal.x, h)] = 0;
+		}
+
+		// Relax turns, follows and reverses
+		bool changed = true;
+		while(changed) {
+			changed = false;
+			for(uint8_t x=X_MIN; x<=X_MAX; x++) {
+				for(uint8_t h=0; h<4; h++) {
+					uint8_t n = node(x, h);
+					uint16_t best = cost[n];
+					uint8_t bestLeg = leg[n];
+
+					// Turns in place
+					for(uint8_t h2=0; h2<4; h2++) {
+						if(h2 == h || cost[node(x, h2)] == COST_INF) continue;
+						uint16_t c = cost[node(x, h2)] +
+							(((h2 ^ h) == 2) ? COST_TURN_180 : COST_TURN_90);
+						if(c < best) {
+							best = c;
+							bestLeg = (LEG_TURN << 4) | h2;
+						}
+					}
+
+					// Follows and reverses along x
+					if(h == HEADING_IDX_R || h == HEADING_IDX_L) {
+						int dir = (h == HEADING_IDX_R) ? +1 : -1;
+						for(uint8_t x2=X_MIN; x2<=X_MAX; x2++) {
+							if(x2 == x || cost[node(x2, h)] == COST_INF) continue;
+							int k = (x2 - x) * dir;
+							bool forward = (k > 0);
+							uint16_t c = cost[node(x2, h)] +
+								(forward ? k * COST_FOLLOW : -k * COST_REVERSE);
+							if(c < best) {
+								best = c;
+								bestLeg = ((forward ? LEG_FOLLOW : LEG_REVERSE) << 4) | x2;
+							}
+						}
+					}
+
+					if(best < cost[n]) {
+						cost[n] = (best < COST_INF) ? best : COST_INF - 1;
+						leg[n] = bestLeg;
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+
+	// Builds route tables for all targets (call in setup).
+	void setup() {
+		plan(0, REACTOR_A);
+		plan(1, REACTOR_B);
+		for(int i=0; i<4; i++) {
+			plan(2 + i, STORAGE[i]);
+			plan(6 + i, SUPPLY[i]);
+		}
+	}
+
+	// Returns first leg type of route from node to target.
+	// Sets arg to the leg's heading or x coordinate.
+	leg_t next(uint8_t x, uint8_t h, const FieldPosition& goal, uint8_t& arg) {
+		int t = target(goal);
+		if(t < 0 || x < X_MIN || x > X_MAX) return LEG_NONE;
+		uint8_t l = legTable[t][node(x, h)];
+		arg = l & 0x0F;
+		return (leg_t)(l >> 4);
+	}
+
+	// Returns route time between field positions (tenths of s).
+	// Routes from tubes or reactors include backing to the line.
+	uint16_t time(const FieldPosition& from, uint8_t h, const FieldPosition& goal) {
+		int t = target(goal);
+		if(t < 0 || from.x < X_MIN || from.x > X_MAX) return TIME_INF;
+		uint16_t c = costTable[t][node(from.x, h)];
+		if(c == COST_INF) return TIME_INF;
+		if(from.y != 0 || target(from) >= 0) c += COST_BACK_TO_LINE;
+		return c;
+	}
+}
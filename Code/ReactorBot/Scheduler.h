@@ -0,0 +1,197 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Scheduler.h
+// Namespace for ReactorBot cooperative multi-rate task scheduler.
+// RBE-2001 A17 Team 7
+
+// Task releases are driven by a 1 kHz hardware timebase. The Timer2
+// compare interrupt counts ticks and counts down each task's period,
+// raising the task's deadline flag when it expires, so releases
+// stay on the tick grid however long the loop takes. run() starts
+// the highest priority flagged task and records its release-to-start
+// latency. A release while the flag is still raised is counted as an
+// overrun. On the host the ticks are generated from micros() at the
+// start of run().
+
+#pragma once
+#include "Arduino.h"
+#include "CycleHistogram.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace Scheduler {
+
+	// Timebase tick period
+	const uint32_t TICK_PERIOD = 1000; // (us)
+
+	// Control task period shared by fixed-rate controllers
+	const uint32_t CONTROL_PERIOD = 5000; // (us)
+	const float CONTROL_DT = CONTROL_PERIOD * 1e-6; // (s)
+
+	// Periodic task
+	// countdown, release and overruns are written by the tick ISR.
+	typedef void (*task_fn_t)();
+	struct Task {
+		task_fn_t fn;      // Task function
+		uint16_t period;   // Period (ticks)
+		uint16_t countdown; // Ticks to next release
+		uint32_t release;  // Tick of pending release
+		uint32_t runs;     // Times run
+		uint16_t overruns; // Missed releases
+		CycleHistogram latency; // Release to start (us)
+	};
+
+	// Task table (index is priority, 0 is highest)
+	const uint8_t MAX_TASKS = 8;
+	Task tasks[MAX_TASKS];
+	uint8_t numTasks = 0;
+
+	// Timebase state
+	volatile uint32_t ticks = 0; // Ticks since start()
+	volatile uint8_t due = 0;    // Deadline flags (bit i = task i)
+	volatile bool started = false;
+
+	// Adds task with given period (us, a multiple of TICK_PERIOD)
+	// at the next lower priority (call before start).
+	// Returns task index or -1 if the table is full.
+	int add(task_fn_t fn, uint32_t period) {
+		if(numTasks == MAX_TASKS) return -1;
+		Task& t = tasks[numTasks];
+		t.fn = fn;
+		t.period = period / TICK_PERIOD;
+		t.countdown = t.period;
+		t.release = 0;
+		t.runs = 0;
+		t.overruns = 0;
+		t.latency.reset();
+		return numTasks++;
+	}
+
+	// Counts one tick and raises flags of released tasks
+	// (called by the timebase interrupt)
+	void tick() {
+		ticks++;
+		if(!started) return;
+		for(uint8_t i=0; i<numTasks; i++) {
+			Task& t = tasks[i];
+			if(--t.countdown) continue;
+			t.countdown = t.period;
+			uint8_t bit = 1 << i;
+			if(due & bit) {
+				if(t.overruns != 0xFFFF) t.overruns++;
+			} else {
+				due |= bit;
+				t.release = ticks;
+			}
+		}
+	}
+
+#if defined(__AVR__)
+
+	// Timer2 runs at F_CPU / 64 in CTC mode
+	const uint8_t TIMER_TOP = F_CPU / 64 / (1000000 / TICK_PERIOD) - 1;
+	const uint8_t US_PER_COUNT = 64 / (F_CPU / 1000000);
+
+	// Starts Timer2 compare interrupt at the tick rate
+	void startTimer() {
+		TCCR2A = _BV(WGM21); // CTC to OCR2A
+		TCCR2B = _BV(CS22);  // clk / 64
+		OCR2A = TIMER_TOP;
+		TCNT2 = 0;
+		TIFR2 = _BV(OCF2A);
+		TIMSK2 = _BV(OCIE2A);
+	}
+
+	// Returns time since tick count (us, call with interrupts off)
+	uint16_t sinceTick() {
+		uint16_t us = TCNT2 * US_PER_COUNT;
+		if(TIFR2 & _BV(OCF2A)) us += TICK_PERIOD; // Tick pending
+		return us;
+	}
+
+#else
+
+	uint32_t lastTick = 0; // Host time of last tick (us)
+
+	void startTimer() {
+		lastTick = micros();
+	}
+
+	uint16_t sinceTick() {
+		return micros() - lastTick;
+	}
+
+#endif
+
+	// Starts timebase and releases all tasks now (call at end of setup).
+	void start() {
+		startTimer();
+		noInterrupts();
+		for(uint8_t i=0; i<numTasks; i++) tasks[i].release = ticks;
+		due = (1 << numTasks) - 1;
+		started = true;
+		interrupts();
+	}
+
+	// Runs the highest priority task which is due (call in loop).
+	// Returns index of task run or -1 if none were due.
+	int run() {
+#if !defined(__AVR__)
+		while(micros() - lastTick >= TICK_PERIOD) {
+			lastTick += TICK_PERIOD;
+			tick();
+		}
+#endif
+		if(!due) return -1;
+		for(uint8_t i=0; i<numTasks; i++) {
+			uint8_t bit = 1 << i;
+			if(!(due & bit)) continue;
+			Task& t = tasks[i];
+			noInterrupts();
+			due &= ~bit;
+			uint32_t late = (ticks - t.release) * TICK_PERIOD + sinceTick();
+			interrupts();
+			t.latency.add(late);
+			t.fn();
+			t.runs++;
+			return i;
+		}
+		return -1;
+	}
+
+	// Prints runs and overruns of each task as CSV.
+	void print(Print& out) {
+		for(uint8_t i=0; i<numTasks; i++) {
+			out.print(F("task,"));
+			out.print(i);
+			out.print(',');
+			out.print(tasks[i].runs);
+			out.print(',');
+			out.println(tasks[i].overruns);
+		}
+	}
+
+	// Prints release-to-start latency histogram of each task.
+	void printLatency(Print& out) {
+		for(uint8_t i=0; i<numTasks; i++)
+			tasks[i].latency.print(out, "latency,", i);
+	}
+
+	// Clears latency histograms
+	void resetLatency() {
+		for(uint8_t i=0; i<numTasks; i++) tasks[i].latency.reset();
+	}
+}
+
+#if defined(__AVR__)
+
+// Timebase tick
+ISR(TIMER2_COMPA_vect) {
+	Scheduler::tick();
+}
+
+#endif
@@ -0,0 +1,82 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// SettleDetector.h
+// Class for early completion detection of setpoint moves.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Declares a move complete once braking now would leave it within
+// tolerance. Each sample gives the error e and its rate r, and the
+// predicted residual e + r * coast is where the error ends up if the
+// motor is braked and the mechanism coasts to rest over the coast
+// time. The move is settled once the residual is within errTol and
+// |r| within rateTol for hold samples in a row, so a move still
+// closing in on the target finishes when it gets there instead of
+// creeping through a rate threshold. Feed one call per new sample:
+// sensors that hold their output between samples (such as the IMU)
+// must not be fed the repeated values.
+class SettleDetector {
+public:
+	SettleDetector(float errTol, float rateTol, float coast, uint8_t hold = 2) {
+		this->errTol = errTol;
+		this->rateTol = rateTol;
+		this->coast = coast;
+		this->hold = hold;
+	}
+
+	// Clears history (call at start of move)
+	void reset() {
+		count = 0;
+		primed = false;
+	}
+
+	// Feeds new error sample and its rate of change.
+	// Returns true if settled.
+	bool update(float err, float rate) {
+		this->rate = rate;
+		if(fabs(err + rate * coast) < errTol && fabs(rate) < rateTol) {
+			if(count < hold) count++;
+		} else
+			count = 0;
+		return settled();
+	}
+
+	// Feeds new error sample taken dt after the last one (s),
+	// estimating the rate by differencing filtered over the coast
+	// time, which smooths sensor noise over the prediction horizon.
+	// Returns true if settled.
+	bool updateDiff(float err, float dt) {
+		if(!primed) {
+			primed = true;
+			eLast = err;
+			rate = 0.0;
+			return false;
+		}
+		float r = rate + dt / (coast + dt) * ((err - eLast) / dt - rate);
+		eLast = err;
+		return update(err, r);
+	}
+
+	// Returns true if settled
+	bool settled() const {
+		return count >= hold;
+	}
+
+private:
+	float errTol;  // Residual tolerance
+	float rateTol; // Rate tolerance (per s)
+	float coast;   // Coast time after braking (s)
+	uint8_t hold;  // Samples in tolerance required
+	uint8_t count = 0;   // Samples in tolerance
+	bool primed = false; // Have a previous sample
+	float eLast = 0.0;   // Previous error
+	float rate = 0.0;    // Latest rate estimate
+};
@@ -15,9 +15,16 @@
 // Included Libraries
 #include "Arduino.h"
 #include "LimitSwitch.h"
+#include "CycleHistogram.h"
+#include "BlackBox.h"
+#include "Scheduler.h"
+#include "StateTable.h"
+#include "PidController.h"
 
 // High Level Control
 #include "FieldPosition.h"
+#include "RoutePlanner.h"
+#include "TubeSelector.h"
 #include "Bluetooth.h"
 
 // Physical Object Namespaces
@@ -30,6 +37,8 @@
 // Drive Controllers
 #include "GyroDrive.h"
 #include "LineFollower.h"
+#include "PoseEstimator.h"
+#include "AutoTune.h"
 
 //**************************************************************/
 // INTERNAL ODOMETRY
@@ -41,16 +50,19 @@ FieldPosition targetPos = REACTOR_A;
 
 // Field orientation
 float targetHeading = 0;
+uint8_t headingIdx = RoutePlanner::HEADING_IDX_U;
 const float HEADING_U = PI * 0.0 / 2.0; // Up
 const float HEADING_R = PI * 1.0 / 2.0; // Right
 const float HEADING_D = PI * 2.0 / 2.0; // Down
 const float HEADING_L = PI * 3.0 / 2.0; // Left
+const float HEADINGS[4] = { HEADING_U, HEADING_R, HEADING_D, HEADING_L };
 
 // Arm orientation
 int targetArmAngle = 0;
 
-// Motor angle to inch VTC onto line intersection
-const float VTC_INCH_ANGLE = 2.465;
+// Current route leg
+RoutePlanner::leg_t leg = RoutePlanner::LEG_NONE;
+uint8_t legArg = 0;
 
 //**************************************************************/
 // STATE MACHINE
@@ -76,12 +88,10 @@ enum state_t {
 	STATE_DECIDE_X,
 	STATE_TURNTO_X,
 	STATE_GOTO_X,
+	STATE_REVERSE_X,
 	STATE_PREP_DEPOSIT_1,
 	STATE_PREP_DEPOSIT_2,
 	STATE_APPROACH_REACTOR,
-	STATE_INCH_X,
-	STATE_DECIDE_Y,
-	STATE_TURNTO_Y,
 	STATE_GOTO_Y,
 	STATE_DECIDE_ARM,
 	STATE_ARM_FORWARD,
@@ -89,11 +99,39 @@ enum state_t {
 	STATE_MOVE_GRIPPER,
 	STATE_ARM_REVERSE,
 	STATE_BACK_TO_LINE,
-	STATE_INCH_Y,
 	STATE_SET_TASK,
 	STATE_PICK_STORAGE,
 	STATE_PICK_SUPPLY,
 } state;
+uint16_t stateElapsed = 0; // Time in state while enabled (ms)
+
+// Number of states in state_t
+const int NUM_STATES = STATE_PICK_SUPPLY + 1;
+
+// State names indexed by state_t, for host tools. The robot reports
+// state IDs only, so the unreferenced table is not linked into it.
+const char* const STATE_NAMES[] = {
+	"BEGIN",
+	"DECIDE_X",
+	"TURNTO_X",
+	"GOTO_X",
+	"REVERSE_X",
+	"PREP_DEPOSIT_1",
+	"PREP_DEPOSIT_2",
+	"APPROACH_REACTOR",
+	"GOTO_Y",
+	"DECIDE_ARM",
+	"ARM_FORWARD",
+	"DECIDE_GRIPPER",
+	"MOVE_GRIPPER",
+	"ARM_REVERSE",
+	"BACK_TO_LINE",
+	"SET_TASK",
+	"PICK_STORAGE",
+	"PICK_SUPPLY",
+};
+static_assert(sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]) == NUM_STATES,
+	"STATE_NAMES must name every state_t");
 
 // Field radiation level
 enum radiation_t {
@@ -113,346 +151,625 @@ LimitSwitch reactorSwitch(PIN_SWITCH_REACTOR);
 LimitSwitch tubeSwitch(PIN_SWITCH_TUBE);
 
 //**************************************************************/
-// HELPER FUNCTION DEFINITIONS
+// LOOP PROFILING
 //**************************************************************/
 
-// Returns true if robot is at either reactor
-bool atReactor() {
-	return (currentPos == REACTOR_A)
-		|| (currentPos == REACTOR_B);
+// Cycle time histograms (us)
+CycleHistogram stateTime[NUM_STATES]; // State machine per state
+CycleHistogram commsTime;  // Bluetooth::loop()
+CycleHistogram loopPeriod; // Start-to-start control period
+unsigned long loopStart = 0;
+
+// Prints task overruns and all non-empty histograms over Serial
+void printProfile() {
+	Serial.println(F("task,id,runs,overruns"));
+	Scheduler::print(Serial);
+	Serial.println(F("name,id,n,mean,min,max,"
+		"<32,<64,<128,<256,<512,<1k,<2k,<4k,<8k,>=8k"));
+	loopPeriod.print(Serial, "period,", 0);
+	commsTime.print(Serial, "comms,", 0);
+	Scheduler::printLatency(Serial);
+	for(int i=0; i<NUM_STATES; i++)
+		if(stateTime[i].n) stateTime[i].print(Serial, "state,", i);
 }
 
-// Resets both drive encoders then transitions to given state.
-void resetEncoders(state_t nextState) {
-	MotorL::motor.zeroAngle();
-	MotorR::motor.zeroAngle();
-	state = nextState;
+// Clears all histograms
+void resetProfile() {
+	loopPeriod.reset();
+	commsTime.reset();
+	Scheduler::resetLatency();
+	for(int i=0; i<NUM_STATES; i++) stateTime[i].reset();
 }
 
-// Inches forward by fixed angle then transitions to given state.
-void inchForward(state_t nextState) {
-	LineFollower::drive();
-	if((MotorL::motor.getAngle() +
-		MotorR::motor.getAngle()) >= 2.0 * VTC_INCH_ANGLE)
-	{
-		state = nextState;
+//**************************************************************/
+// BLACK BOX
+//**************************************************************/
+
+// Robot enable state at last comms poll
+bool wasEnabled = false;
+
+// Logs a black box record if one is due (call each control tick)
+void recordBlackBox() {
+	BlackBox::Record* r = BlackBox::next();
+	if(!r) return;
+	bool enabled = Bluetooth::com.getRobotEnabled();
+	r->time = millis();
+	r->state = state;
+	r->mode = task | ((reactor == B) << 2) | (enabled << 3) | (radiation << 4);
+	r->heading = BlackBox::wrap16(GyroDrive::heading() * (65536.0 / TWO_PI));
+	r->gZ = BlackBox::wrap16(ImuSampler::gZ * 1000.0);
+	r->line = BlackBox::wrap16(LineFollower::linePos() * 100.0);
+	r->angleL = BlackBox::wrap16(MotorL::getAngle() * 100.0);
+	r->angleR = BlackBox::wrap16(MotorR::getAngle() * 100.0);
+	r->arm = Arm::getAngle();
+	r->uHeading = BlackBox::volts(GyroDrive::anglePid.output());
+	r->uRate = BlackBox::volts(GyroDrive::velPid.output());
+	r->uArm = BlackBox::volts(Arm::settled ? 0.0 : Arm::pid.output());
+}
+
+//**************************************************************/
+// PID BENCHMARK
+//**************************************************************/
+
+// Times float and fixed-point PID updates with the yaw rate gains
+// and prints CPU cycles per update.
+void benchmarkPid() {
+	const int N = 1000;
+	PidController floatPid(
+		GyroDrive::VEL_KP,
+		GyroDrive::VEL_KI,
+		GyroDrive::VEL_KD,
+		-GyroDrive::VEL_VMAX,
+		+GyroDrive::VEL_VMAX);
+	FixedPid fixedPid(
+		GyroDrive::VEL_KP,
+		GyroDrive::VEL_KI,
+		GyroDrive::VEL_KD,
+		-GyroDrive::VEL_VMAX,
+		+GyroDrive::VEL_VMAX,
+		GyroDrive::VEL_ERR_MAX,
+		Scheduler::CONTROL_DT);
+	volatile float u = 0.0;
+	unsigned long t0 = micros();
+	for(int i=0; i<N; i++) u = floatPid.update(0.01 * (i % 64) - 0.3);
+	unsigned long t1 = micros();
+	for(int i=0; i<N; i++) u = fixedPid.update(0.01 * (i % 64) - 0.3);
+	unsigned long t2 = micros();
+	(void)u;
+	const float cyclesPerUs = F_CPU / 1.0e6;
+	Serial.print(F("pid,float,"));
+	Serial.println((t1 - t0) * cyclesPerUs / N);
+	Serial.print(F("pid,fixed,"));
+	Serial.println((t2 - t1) * cyclesPerUs / N);
+}
+
+//**************************************************************/
+// ENCODER BENCHMARK
+//**************************************************************/
+
+// Prints encoder ISR cycles and the fastest trackable wheel speed
+// if both encoders together may use the whole CPU.
+void benchmarkEncoders() {
+	uint16_t cycles = MotorL::encoder.measureIsrCycles();
+	Serial.print(F("enc,cycles,"));
+	Serial.println(cycles);
+	if(cycles == 0) return;
+	float edgesPerSec = F_CPU / (2.0 * cycles);
+	Serial.print(F("enc,max_edges_per_s,"));
+	Serial.println(edgesPerSec);
+	Serial.print(F("enc,max_wheel_rad_per_s,"));
+	Serial.println(edgesPerSec * TWO_PI / MotorL::ENCODER_CPR);
+}
+
+//**************************************************************/
+// SERIAL CONSOLE
+//**************************************************************/
+
+// Handles single-character commands from the USB serial port.
+// 'p': Print loop profile
+// 'r': Reset loop profile
+// 'f': Benchmark float vs fixed-point PID
+// 'e': Benchmark encoder ISR
+// 'b': Dump black box
+// 't': Auto-tune PID gains (robot must be enabled)
+// 'g': Print PID gains
+// 'd': Restore default PID gains
+// 'i': Identify drive motor model (robot must be enabled)
+// Black box dumps and console output share the port, so commands
+// wait while a dump is being sent (see robotDump()).
+void serialCommands() {
+	if(BlackBox::dumping || !Serial.available()) return;
+	switch(Serial.read()) {
+		case 'p': printProfile(); break;
+		case 'r': resetProfile(); break;
+		case 'f': benchmarkPid(); break;
+		case 'e': benchmarkEncoders(); break;
+		case 'b': BlackBox::dump(); break;
+		case 't': AutoTune::start(); break;
+		case 'g': AutoTune::print(Serial); break;
+		case 'd': AutoTune::restoreDefaults(); break;
+		case 'i': DriveModel::startIdent(); break;
+		default: break;
 	}
 }
 
 //**************************************************************/
-// MAIN FUNCTION DEFINITIONS
+// HELPER FUNCTION DEFINITIONS
 //**************************************************************/
 
-// Initializes ReactorBot (call in setup).
-void robotSetup() {
+// Returns field position of current reactor
+const FieldPosition& reactorPos() {
+	return (reactor == A) ? REACTOR_A : REACTOR_B;
+}
 
-	// Namespace initializations
-	MotorL::setup();
-	MotorR::setup();
-	Arm::setup();
-	Gripper::setup();
-	GyroDrive::setup();
-	LineFollower::setup();
-	Bluetooth::setup();
-	IndicatorLed::setup();
+// Sets target position to the tube for the current task with the
+// least remaining mission time from the robot's node, given latest
+// tube availability. Returns false (target unchanged) if none.
+bool pickTube() {
+	int i;
+	switch(task) {
+		case TASK_FILL_STORAGE:
+			i = TubeSelector::pickStorage(currentPos, headingIdx, reactorPos(),
+				Bluetooth::com.getStorageData(),
+				Bluetooth::com.getSupplyData());
+			if(i) targetPos = STORAGE[i-1];
+			return i != 0;
+		case TASK_GET_SUPPLY:
+			i = TubeSelector::pickSupply(currentPos, headingIdx, reactorPos(),
+				Bluetooth::com.getSupplyData());
+			if(i) targetPos = SUPPLY[i-1];
+			return i != 0;
+		default:
+			return true;
+	}
+}
 
-	// Limit Switch initializations
-	reactorSwitch.setup();
-	tubeSwitch.setup();
+// Brakes both drive motors.
+void brakeDrive() {
+	MotorL::motor.brake();
+	MotorR::motor.brake();
+}
 
-	// Open gripper and raise arm to back position
-	Gripper::open();
-	while(!Gripper::ready());
-	while(!Arm::setAngle(Arm::ANGLE_BACK));
+// Returns distance left on current x leg from pose (m)
+// Follow and reverse legs end with the VTC on intersection
+// x = legArg. Arrive legs end with the line sensor on it.
+float legRemaining() {
+	float d = -PoseEstimator::pastNode(legArg, 0, HEADINGS[headingIdx]);
+	if(leg == RoutePlanner::LEG_REVERSE) d = -d;
+	if(leg == RoutePlanner::LEG_ARRIVE) d -= PoseEstimator::SENSOR_OFFSET;
+	return d;
+}
 
-	// State machine initialization
-	state = STATE_BEGIN;
+// Drives backwards on the leg speed profile to end given
+// distance behind the VTC (m)
+void reverseTo(float remaining) {
+	float w = LineFollower::profile.update(
+		remaining / PoseEstimator::WHEEL_RADIUS, LineFollower::SPEED_MIN);
+	GyroDrive::setVelocity(0.0, -w);
 }
 
-// Robot state machine loop (call in loop).
-void robotLoop() {
+//**************************************************************/
+// STATE HANDLER DEFINITIONS
+//**************************************************************/
 
-	// Bluetooth communication
-	Bluetooth::loop(radiation);
+using StateTable::outcome_t;
+using StateTable::OUT_STAY;
+using StateTable::OUT_DONE;
+using StateTable::OUT_ALT_1;
+using StateTable::OUT_ALT_2;
+using StateTable::OUT_ALT_3;
+
+// Initialize state machine
+outcome_t updateBegin() {
+	reactor = A;
+	task = TASK_EMPTY_REACTOR;
+	radiation = RAD_NONE;
+	targetPos = REACTOR_A;
+	return OUT_DONE;
+}
 
-	// State Machine
-	switch(state) {
+// Look up next route leg to target position
+// Tube targets are re-picked in case availability changed. With no
+// tube available or no route to the target, the robot waits braked.
+outcome_t updateDecideX() {
+	if(!pickTube()) {
+		brakeDrive();
+		return OUT_STAY;
+	}
+	leg = RoutePlanner::next(
+		currentPos.x, headingIdx, targetPos, legArg);
+	switch(leg) {
+		case RoutePlanner::LEG_NONE:
+			brakeDrive();
+			return OUT_STAY; // No route
+		case RoutePlanner::LEG_TURN:
+			targetHeading = HEADINGS[legArg];
+			return OUT_DONE; // Turn
+		case RoutePlanner::LEG_FOLLOW:
+		case RoutePlanner::LEG_ARRIVE:
+			return OUT_ALT_1; // Line follow
+		case RoutePlanner::LEG_REVERSE:
+			return OUT_ALT_2; // Reverse
+		case RoutePlanner::LEG_DONE:
+			return OUT_ALT_3; // Facing target tube
+	}
+	return OUT_STAY;
+}
 
-		// Initialize state machine
-		case STATE_BEGIN:
-			reactor = A;
-			task = TASK_EMPTY_REACTOR;
-			state = STATE_DECIDE_X;
-			radiation = RAD_NONE;
-			targetPos = REACTOR_A;
-			break;
+// Start profiled turn to leg heading
+void enterTurnToX() {
+	GyroDrive::startTurn(targetHeading);
+}
 
-		// Decide on x turning direction
-		case STATE_DECIDE_X:
-			if(targetPos.x == currentPos.x)
-				state = STATE_DECIDE_Y;
-			else {
-				if(targetPos.x > currentPos.x)
-					targetHeading = HEADING_R;
-				else
-					targetHeading = HEADING_L;
-				state = STATE_TURNTO_X;
-			}
-			break;
+// Gyro turn to leg heading
+outcome_t updateTurnToX() {
+	return GyroDrive::turn() ? OUT_DONE : OUT_STAY;
+}
 
-		// Gyro turn to face target position x
-		case STATE_TURNTO_X:
-			if(GyroDrive::setAngle(targetHeading))
-				state = STATE_GOTO_X;
-			break;
+// Take field heading nearest the measured one, so a turn which
+// timed out is planned from where the robot actually points
+void exitTurnToX() {
+	float best = TWO_PI;
+	for(uint8_t i=0; i<4; i++) {
+		float err = fabs(GyroDrive::angleError(HEADINGS[i]));
+		if(err < best) {
+			best = err;
+			headingIdx = i;
+		}
+	}
+}
 
-		// Line follow to target position x
-		case STATE_GOTO_X:
-			LineFollower::drive();
-			if(LineFollower::hitIntersection()) {
-				if(GyroDrive::heading() < PI) currentPos.x++;
-				else currentPos.x--;
-			}
-			if(currentPos.x == targetPos.x) {
-				switch(task) {
-					case TASK_EMPTY_REACTOR:
-						state = STATE_APPROACH_REACTOR;
-						break;
-					case TASK_FILL_REACTOR:
-						MotorL::motor.brake();
-						MotorR::motor.brake();
-						state = STATE_PREP_DEPOSIT_1;
-						break;
-					default:
-						resetEncoders(STATE_INCH_X);
-						break;
-				}
-			}
-			break;
+// Start drive legs from low speed
+void enterDriveLeg() {
+	LineFollower::profile.reset(LineFollower::SPEED_MIN);
+}
 
-		// Lower arm halfway to deposit reactor rod
-		case STATE_PREP_DEPOSIT_1:
-			if(Arm::setAngle(Arm::ANGLE_PREP_1))
-				state = STATE_PREP_DEPOSIT_2;
-			break;
+// Line follow to leg position x on speed profile
+outcome_t updateGoToX() {
+	float d = legRemaining();
+	LineFollower::driveTo(d / PoseEstimator::WHEEL_RADIUS);
+	if(leg == RoutePlanner::LEG_ARRIVE && task == TASK_FILL_REACTOR
+		&& d <= PoseEstimator::GRID)
+	{
+		Arm::setTarget(Arm::ANGLE_PREP_1); // Pre-lower on last leg
+	}
+	if(d > 0.0) return OUT_STAY;
+	if(leg != RoutePlanner::LEG_ARRIVE) return OUT_DONE;
+	if(task == TASK_FILL_REACTOR) return OUT_ALT_1; // Prepare arm
+	return OUT_ALT_2; // Approach
+}
 
-		// Raise arm up a bit to avoid reactor collision
-		case STATE_PREP_DEPOSIT_2:
-			if(Arm::setAngle(Arm::ANGLE_PREP_2))
-				state = STATE_APPROACH_REACTOR;
-			break;
+// Gyro drive backwards to leg position x on speed profile
+outcome_t updateReverseX() {
+	float d = legRemaining();
+	reverseTo(d);
+	return (d <= 0.0) ? OUT_DONE : OUT_STAY;
+}
 
-		// Line follow until reactor limit switch contact
-		case STATE_APPROACH_REACTOR:
-			LineFollower::drive(2.0);
-			if(reactorSwitch.pressed())
-				state = STATE_DECIDE_ARM;
-			break;
+// Robot is at leg position x
+void exitDriveLeg() {
+	currentPos.x = legArg;
+}
 
-		// Inch forward until robot VTC is on line intersection
-		case STATE_INCH_X:
-			inchForward(STATE_DECIDE_Y);
-			break;
+// Lower arm halfway to deposit reactor rod
+outcome_t updatePrepDeposit1() {
+	Arm::setTarget(Arm::ANGLE_PREP_1);
+	return Arm::ready() ? OUT_DONE : OUT_STAY;
+}
 
-		// Decide on y turning direction
-		case STATE_DECIDE_Y:
-			if(targetPos.y == currentPos.y)
-				state = STATE_DECIDE_ARM;
-			else {
-				if(targetPos.y > currentPos.y)
-					targetHeading = HEADING_U;
-				else
-					targetHeading = HEADING_D;
-				state = STATE_TURNTO_Y;
-			}
-			break;
+// Raise arm up a bit to avoid reactor collision
+outcome_t updatePrepDeposit2() {
+	Arm::setTarget(Arm::ANGLE_PREP_2);
+	return Arm::ready() ? OUT_DONE : OUT_STAY;
+}
 
-		// Turn to face target position y
-		case STATE_TURNTO_Y:
-			if(GyroDrive::setAngle(targetHeading))
-				state = STATE_GOTO_Y;
-			break;
+// Line follow until reactor limit switch contact
+outcome_t updateApproachReactor() {
+	LineFollower::drive(LineFollower::SPEED_MIN);
+	return reactorSwitch.pressed() ? OUT_DONE : OUT_STAY;
+}
 
-		// Line follow until tube limit switch contact
-		case STATE_GOTO_Y:
-			LineFollower::drive();
-			if(tubeSwitch.pressed()) {
-				switch(task) {
-					case TASK_FILL_STORAGE:
-						currentPos.y = +1;
-						break;
-					case TASK_GET_SUPPLY:
-						currentPos.y = -1;
-						break;
-					default: break;
-				}
-				state = STATE_DECIDE_ARM;
-			}
-			break;
+// Line follow until tube limit switch contact
+outcome_t updateGoToY() {
+	LineFollower::drive();
+	return tubeSwitch.pressed() ? OUT_DONE : OUT_STAY;
+}
 
-		// Stop driving and choose arm forward position
-		case STATE_DECIDE_ARM:
-			MotorL::motor.brake();
-			MotorR::motor.brake();
-			switch(task) {
-				case TASK_EMPTY_REACTOR:
-					targetArmAngle = Arm::ANGLE_PICKUP;
-					break;
-				case TASK_FILL_REACTOR:
-					targetArmAngle = Arm::ANGLE_DROPOFF;
-					break;
-				default:
-					targetArmAngle = Arm::ANGLE_TUBE;
-			}
-			state = STATE_ARM_FORWARD;
-			break;
+// Robot is at target tube
+void exitGoToY() {
+	currentPos.y = targetPos.y;
+}
 
-		// Move arm to forward position
-		case STATE_ARM_FORWARD:
-			if(Arm::setAngle(targetArmAngle))
-				state = STATE_DECIDE_GRIPPER;
+// Stop driving and choose arm forward position
+outcome_t updateDecideArm() {
+	switch(task) {
+		case TASK_EMPTY_REACTOR:
+			targetArmAngle = Arm::ANGLE_PICKUP;
 			break;
-
-		// Choose gripper action
-		case STATE_DECIDE_GRIPPER:
-			switch(task) {
-				case TASK_EMPTY_REACTOR:
-				case TASK_GET_SUPPLY:
-					Gripper::close();
-					break;
-				default:
-					Gripper::open();
-					break;
-			}
-			state = STATE_MOVE_GRIPPER;
+		case TASK_FILL_REACTOR:
+			targetArmAngle = Arm::ANGLE_DROPOFF;
 			break;
+		default:
+			targetArmAngle = Arm::ANGLE_TUBE;
+	}
+	return OUT_DONE;
+}
 
-		// Wait for gripper to finish action
-		case STATE_MOVE_GRIPPER:
-			if(Gripper::ready()) {
-				switch(task) {
-					case TASK_GET_SUPPLY:
-						radiation = RAD_HIGH;
-						break;
-					case TASK_EMPTY_REACTOR:
-						radiation = RAD_LOW;
-						break;
-					default:
-						radiation = RAD_NONE;
-						break;
-				}
-				state = STATE_ARM_REVERSE;
-			}
-			break;
+// Move arm to forward position
+outcome_t updateArmForward() {
+	Arm::setTarget(targetArmAngle);
+	return Arm::ready() ? OUT_DONE : OUT_STAY;
+}
 
-		// Move arm to back position
-		case STATE_ARM_REVERSE:
-			if(Arm::setAngle(Arm::ANGLE_BACK))
-				state = STATE_BACK_TO_LINE;
+// Choose gripper action
+outcome_t updateDecideGripper() {
+	switch(task) {
+		case TASK_EMPTY_REACTOR:
+		case TASK_GET_SUPPLY:
+			Gripper::close();
 			break;
-
-		// Gyro drive backwards to line intersection
-		case STATE_BACK_TO_LINE:
-			GyroDrive::setVelocity(0.0, -4.0); // Drive backwards
-			if(LineFollower::hitIntersection()) {
-				currentPos.y = 0;
-				if(atReactor()) state = STATE_SET_TASK;
-				else resetEncoders(STATE_INCH_Y);
-			}
+		default:
+			Gripper::open();
 			break;
+	}
+	return OUT_DONE;
+}
 
-		// Inch forward until robot VTC is on line intersection
-		case STATE_INCH_Y:
-			inchForward(STATE_SET_TASK);
+// Wait for gripper to finish action
+outcome_t updateMoveGripper() {
+	if(!Gripper::ready()) return OUT_STAY;
+	switch(task) {
+		case TASK_GET_SUPPLY:
+			radiation = RAD_HIGH;
 			break;
-
-		// Set next robot task, state, and target position
-		case STATE_SET_TASK:
-			MotorL::motor.brake();
-			MotorR::motor.brake();
-			switch(task) {
-				case TASK_EMPTY_REACTOR:
-					task = TASK_FILL_STORAGE;
-					state = STATE_PICK_STORAGE;
-					break;
-				case TASK_FILL_STORAGE:
-					task = TASK_GET_SUPPLY;
-					state = STATE_PICK_SUPPLY;
-					break;
-				case TASK_GET_SUPPLY:
-					task = TASK_FILL_REACTOR;
-					switch(reactor) {
-						case A: targetPos = REACTOR_A; break;
-						case B: targetPos = REACTOR_B; break;
-					}
-					state = STATE_DECIDE_X;
-					break;
-				case TASK_FILL_REACTOR:
-					task = TASK_EMPTY_REACTOR;
-					switch(reactor) {
-						case A:
-							reactor = B;
-							targetPos = REACTOR_B;
-							break;
-						case B:
-							reactor = A;
-							targetPos = REACTOR_A;
-							break;
-					}
-					state = STATE_DECIDE_X;
-					break;
-			}
+		case TASK_EMPTY_REACTOR:
+			radiation = RAD_LOW;
 			break;
-
-		// Set target position to closest available storage tube
-		case STATE_PICK_STORAGE:
-			switch(reactor) {
-				case A: // Storage 4 is closest
-					for(int i=4; i>=1; i--)
-						if(Bluetooth::com.storageAvailable(i)) {
-							targetPos = STORAGE[i-1];
-							state = STATE_DECIDE_X;
-							break;
-						}
-					break;
-				case B: // Storage 1 is closest
-					for(int i=1; i<=4; i++)
-						if(Bluetooth::com.storageAvailable(i)) {
-							targetPos = STORAGE[i-1];
-							state = STATE_DECIDE_X;
-							break;
-						}
-					break;
-			}
+		default:
+			radiation = RAD_NONE;
 			break;
+	}
+	return OUT_DONE;
+}
 
-		// Set target position to closest available supply tube
-		case STATE_PICK_SUPPLY:
-			switch(reactor) {
-				case A: // Supply 1 is closest
-					for(int i=1; i<=4; i++)
-						if(Bluetooth::com.supplyAvailable(i)) {
-							targetPos = SUPPLY[i-1];
-							state = STATE_DECIDE_X;
-							break;
-						}
-					break;
-				case B: // Supply 4 is closest
-					for(int i=4; i>=1; i--)
-						if(Bluetooth::com.supplyAvailable(i)) {
-							targetPos = SUPPLY[i-1];
-							state = STATE_DECIDE_X;
-							break;
-						}
-					break;
-			}
-			break;
+// Swing arm back until rod is clear (arm finishes while driving)
+outcome_t updateArmReverse() {
+	Arm::setTarget(Arm::ANGLE_BACK);
+	return (Arm::getAngle() >= Arm::ANGLE_CLEAR) ? OUT_DONE : OUT_STAY;
+}
+
+// Gyro drive backwards until VTC is on line intersection
+outcome_t updateBackToLine() {
+	float d = PoseEstimator::pastNode(currentPos.x, 0, HEADINGS[headingIdx]);
+	reverseTo(d);
+	return (d <= 0.0) ? OUT_DONE : OUT_STAY;
+}
+
+// Robot is back on line intersection
+void exitBackToLine() {
+	currentPos.y = 0;
+}
+
+// Set next robot task and target position
+outcome_t updateSetTask() {
+	switch(task) {
+		case TASK_EMPTY_REACTOR:
+			task = TASK_FILL_STORAGE;
+			return OUT_ALT_1; // Pick storage
+		case TASK_FILL_STORAGE:
+			task = TASK_GET_SUPPLY;
+			return OUT_ALT_2; // Pick supply
+		case TASK_GET_SUPPLY:
+			task = TASK_FILL_REACTOR;
+			targetPos = reactorPos();
+			return OUT_DONE;
+		case TASK_FILL_REACTOR:
+			task = TASK_EMPTY_REACTOR;
+			reactor = (reactor == A) ? B : A;
+			targetPos = reactorPos();
+			return OUT_DONE;
 	}
+	return OUT_STAY;
+}
+
+// Set target position to best available tube
+outcome_t updatePickTube() {
+	return pickTube() ? OUT_DONE : OUT_STAY;
+}
 
-	// Update radiation indicator LED
+//**************************************************************/
+// STATE TABLE
+//**************************************************************/
+
+// Transition table indexed by state_t
+// Rows: enter, update, exit, {done, alt 1, alt 2, alt 3},
+// timeout (ms), fallback. Timeouts end waits whose sensor or
+// settling condition may never be met, continuing the mission.
+using StateTable::NONE;
+constexpr StateTable::State STATE_TABLE[NUM_STATES] = {
+	/* BEGIN */ { nullptr, updateBegin, nullptr,
+		{ STATE_DECIDE_X, NONE, NONE, NONE }, 0, NONE },
+	/* DECIDE_X */ { nullptr, updateDecideX, nullptr,
+		{ STATE_TURNTO_X, STATE_GOTO_X, STATE_REVERSE_X, STATE_GOTO_Y }, 0, NONE },
+	/* TURNTO_X */ { enterTurnToX, updateTurnToX, exitTurnToX,
+		{ STATE_DECIDE_X, NONE, NONE, NONE }, 5000, STATE_DECIDE_X },
+	/* GOTO_X */ { enterDriveLeg, updateGoToX, exitDriveLeg,
+		{ STATE_DECIDE_X, STATE_PREP_DEPOSIT_1, STATE_APPROACH_REACTOR, NONE }, 0, NONE },
+	/* REVERSE_X */ { enterDriveLeg, updateReverseX, exitDriveLeg,
+		{ STATE_DECIDE_X, NONE, NONE, NONE }, 0, NONE },
+	/* PREP_DEPOSIT_1 */ { brakeDrive, updatePrepDeposit1, nullptr,
+		{ STATE_PREP_DEPOSIT_2, NONE, NONE, NONE }, 4000, STATE_PREP_DEPOSIT_2 },
+	/* PREP_DEPOSIT_2 */ { nullptr, updatePrepDeposit2, nullptr,
+		{ STATE_APPROACH_REACTOR, NONE, NONE, NONE }, 4000, STATE_APPROACH_REACTOR },
+	/* APPROACH_REACTOR */ { nullptr, updateApproachReactor, nullptr,
+		{ STATE_DECIDE_ARM, NONE, NONE, NONE }, 5000, STATE_DECIDE_ARM },
+	/* GOTO_Y */ { nullptr, updateGoToY, exitGoToY,
+		{ STATE_DECIDE_ARM, NONE, NONE, NONE }, 5000, STATE_DECIDE_ARM },
+	/* DECIDE_ARM */ { brakeDrive, updateDecideArm, nullptr,
+		{ STATE_ARM_FORWARD, NONE, NONE, NONE }, 0, NONE },
+	/* ARM_FORWARD */ { nullptr, updateArmForward, nullptr,
+		{ STATE_DECIDE_GRIPPER, NONE, NONE, NONE }, 4000, STATE_DECIDE_GRIPPER },
+	/* DECIDE_GRIPPER */ { nullptr, updateDecideGripper, nullptr,
+		{ STATE_MOVE_GRIPPER, NONE, NONE, NONE }, 0, NONE },
+	/* MOVE_GRIPPER */ { nullptr, updateMoveGripper, nullptr,
+		{ STATE_ARM_REVERSE, NONE, NONE, NONE }, 0, NONE },
+	/* ARM_REVERSE */ { nullptr, updateArmReverse, nullptr,
+		{ STATE_BACK_TO_LINE, NONE, NONE, NONE }, 4000, STATE_BACK_TO_LINE },
+	/* BACK_TO_LINE */ { enterDriveLeg, updateBackToLine, exitBackToLine,
+		{ STATE_SET_TASK, NONE, NONE, NONE }, 0, NONE },
+	/* SET_TASK */ { brakeDrive, updateSetTask, nullptr,
+		{ STATE_DECIDE_X, STATE_PICK_STORAGE, STATE_PICK_SUPPLY, NONE }, 0, NONE },
+	/* PICK_STORAGE */ { nullptr, updatePickTube, nullptr,
+		{ STATE_DECIDE_X, NONE, NONE, NONE }, 0, NONE },
+	/* PICK_SUPPLY */ { nullptr, updatePickTube, nullptr,
+		{ STATE_DECIDE_X, NONE, NONE, NONE }, 0, NONE },
+};
+
+static_assert(NUM_STATES <= 32,
+	"State table checks use 32-bit state masks");
+static_assert(StateTable::validTargets(STATE_TABLE, NUM_STATES),
+	"State table has a missing handler or invalid next state");
+static_assert(StateTable::allReachable(STATE_TABLE, NUM_STATES, STATE_BEGIN),
+	"State table has a state unreachable from STATE_BEGIN");
+static_assert(StateTable::noDeadEnds(STATE_TABLE, NUM_STATES, STATE_SET_TASK),
+	"State table has a state that cannot return to STATE_SET_TASK");
+
+//**************************************************************/
+// TASK FUNCTION DEFINITIONS
+//**************************************************************/
+
+// Task periods (us)
+const uint32_t PERIOD_CONTROL = Scheduler::CONTROL_PERIOD; // Control
+const uint32_t PERIOD_COMMS = 10000;      // Bluetooth polling
+const uint32_t PERIOD_INDICATE = 100000;  // Radiation LED
+const uint32_t PERIOD_DIAGNOSE = 100000;  // Serial console
+const uint32_t PERIOD_HEARTBEAT = 1000000; // Bluetooth heartbeat
+const uint32_t PERIOD_DUMP = 10000;       // Black box dump
+
+// Forward declarations
+void robotControl();
+
+// Polls Bluetooth and enables or disables the drive.
+// Dumps the black box when reactor control stops the robot.
+void robotComms() {
+	unsigned long t0 = micros();
+	Bluetooth::loop(radiation);
+	bool enabled = Bluetooth::com.getRobotEnabled();
+	if(wasEnabled && !enabled) BlackBox::dump();
+	wasEnabled = enabled;
+	commsTime.add(micros() - t0);
+}
+
+// Updates radiation indicator LED.
+void robotIndicate() {
 	switch(radiation) {
 		case RAD_HIGH: IndicatorLed::setHigh(); break;
 		case RAD_LOW:  IndicatorLed::setLow();  break;
 		case RAD_NONE: IndicatorLed::setNone(); break;
 	}
 }
+
+// Sends Bluetooth heartbeat and radiation alerts.
+void robotHeartbeat() {
+	Bluetooth::heartbeat(radiation);
+}
+
+// Sends pending black box dump over USB serial.
+// Auto-tuning and model identification stream CSV over the same
+// port, so a dump requested meanwhile waits (with the ring frozen)
+// until they finish.
+void robotDump() {
+	if(AutoTune::active || DriveModel::identActive) return;
+	BlackBox::service(Serial);
+}
+
+//**************************************************************/
+// MAIN FUNCTION DEFINITIONS
+//**************************************************************/
+
+// Initializes ReactorBot (call in setup).
+void robotSetup() {
+
+	// Namespace initializations
+	Serial.begin(115200);
+	MotorL::setup();
+	MotorR::setup();
+	Arm::setup();
+	Gripper::setup();
+	GyroDrive::setup();
+	PoseEstimator::setup(currentPos.x * PoseEstimator::GRID, 0.0);
+	LineFollower::setup();
+	Bluetooth::setup();
+	IndicatorLed::setup();
+	AdcSampler::start();
+	RoutePlanner::setup();
+	AutoTune::setup();
+
+	// Limit Switch initializations
+	reactorSwitch.setup();
+	tubeSwitch.setup();
+
+	// Tube switch held at boot starts auto-tuning
+	if(tubeSwitch.pressed()) AutoTune::start();
+
+	// Open gripper (arm raises to back position in control task)
+	Gripper::open();
+	while(!Gripper::ready()) AdcSampler::update();
+	Arm::setTarget(Arm::ANGLE_BACK);
+
+	// State machine initialization
+	state = STATE_BEGIN;
+	stateElapsed = 0;
+
+	// Tasks in priority order
+	Scheduler::add(robotControl, PERIOD_CONTROL);
+	Scheduler::add(robotComms, PERIOD_COMMS);
+	Scheduler::add(robotHeartbeat, PERIOD_HEARTBEAT);
+	Scheduler::add(robotIndicate, PERIOD_INDICATE);
+	Scheduler::add(serialCommands, PERIOD_DIAGNOSE);
+	Scheduler::add(robotDump, PERIOD_DUMP);
+	Scheduler::start();
+}
+
+// Services IMU bus and runs due robot tasks (call in loop).
+void robotLoop() {
+	ImuSampler::poll();
+	Scheduler::run();
+}
+
+// Robot state machine and control loops (fixed-rate task).
+void robotControl() {
+
+	// Control period
+	unsigned long t1 = micros();
+	if(loopStart) loopPeriod.add(t1 - loopStart);
+	loopStart = t1;
+
+	// Latest sensor samples and pose
+	AdcSampler::update();
+	PoseEstimator::update(LineFollower::hitIntersection());
+
+	// State Machine (held while disabled by reactor control)
+	// Auto-tuning and model identification take over from it until
+	// finished.
+	state_t profiledState = state;
+	bool enabled = Bluetooth::com.getRobotEnabled();
+	if(AutoTune::active) {
+		if(enabled) AutoTune::update();
+		else AutoTune::hold();
+	} else if(DriveModel::identActive) {
+		if(enabled) DriveModel::updateIdent();
+		else DriveModel::holdIdent();
+	} else if(enabled) {
+		stateElapsed += PERIOD_CONTROL / 1000;
+		state = (state_t)StateTable::step(STATE_TABLE, state, stateElapsed);
+	}
+
+	// Concurrent actuators (arm held while disabled)
+	if(!AutoTune::ownsArm()) {
+		if(enabled) Arm::loop();
+		else Arm::hold();
+	}
+	recordBlackBox();
+	stateTime[profiledState].add(micros() - t1);
+}
@@ -0,0 +1,119 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// StateTable.h
+// Namespace for table-driven state machines with compile-time checks.
+// RBE-2001 A17 Team 7
+
+// A machine is a constexpr array of State rows indexed by state ID.
+// Each row holds optional entry and exit hooks, an update handler
+// returning an outcome code, the next state for each outcome, and an
+// optional timeout with a fallback state. step() runs one update and
+// takes any transition with a table lookup. The constexpr checks
+// below let the owner static_assert that all transitions are valid,
+// all states are reachable, and no state is a dead end.
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace StateTable {
+
+	// Update handler outcomes (meaning of alternates is per state)
+	enum outcome_t : uint8_t {
+		OUT_STAY,  // Remain in state
+		OUT_DONE,  // Primary next state
+		OUT_ALT_1, // Alternate next states
+		OUT_ALT_2,
+		OUT_ALT_3,
+	};
+	const uint8_t NUM_OUTCOMES = OUT_ALT_3; // Excluding OUT_STAY
+	const uint8_t NONE = 0xFF; // No next state
+
+	// State table row
+	struct State {
+		void (*enter)();          // Called on entry (or nullptr)
+		outcome_t (*update)();    // Called each control tick
+		void (*exit)();           // Called on exit (or nullptr)
+		uint8_t next[NUM_OUTCOMES]; // Next state per outcome
+		uint16_t timeout;         // Time limit (ms, 0 = none)
+		uint8_t fallback;         // Next state on timeout
+	};
+
+	//**************************************************************/
+	// COMPILE-TIME CHECKS
+	//**************************************************************/
+
+	// Returns bit mask of state s (0 for NONE)
+	constexpr uint32_t bit(uint8_t s) {
+		return (s == NONE) ? 0 : ((uint32_t)1 << s);
+	}
+
+	// Returns bit mask of all n states
+	constexpr uint32_t all(uint8_t n) {
+		return (n == 32) ? 0xFFFFFFFF : (((uint32_t)1 << n) - 1);
+	}
+
+	// Returns mask of states entered directly from state s
+	constexpr uint32_t successors(const State* t, uint8_t s, uint8_t o = 0) {
+		return (o == NUM_OUTCOMES)
+			? (t[s].timeout ? bit(t[s].fallback) : 0)
+			: (bit(t[s].next[o]) | successors(t, s, o + 1));
+	}
+
+	// Returns mask m plus successors of all states in m
+	constexpr uint32_t expand(const State* t, uint8_t n, uint32_t m, uint8_t s = 0) {
+		return (s == n) ? m
+			: expand(t, n, m | (((m >> s) & 1) ? successors(t, s) : 0), s + 1);
+	}
+
+	// Returns mask of states reachable from states in m
+	constexpr uint32_t reachable(const State* t, uint8_t n, uint32_t m) {
+		return (expand(t, n, m) == m) ? m : reachable(t, n, expand(t, n, m));
+	}
+
+	// Returns true if all next and fallback states exist
+	constexpr bool validTargets(const State* t, uint8_t n, uint8_t s = 0) {
+		return (s == n) ? true
+			: ((successors(t, s) & ~all(n)) == 0) && t[s].update != nullptr
+				&& validTargets(t, n, s + 1);
+	}
+
+	// Returns true if every state is reachable from state start
+	constexpr bool allReachable(const State* t, uint8_t n, uint8_t start) {
+		return reachable(t, n, bit(start)) == all(n);
+	}
+
+	// Returns true if state home is reachable from every state
+	constexpr bool noDeadEnds(const State* t, uint8_t n, uint8_t home, uint8_t s = 0) {
+		return (s == n) ? true
+			: ((reachable(t, n, successors(t, s)) & bit(home)) != 0)
+				&& noDeadEnds(t, n, home, s + 1);
+	}
+
+	//**************************************************************/
+	// RUNTIME
+	//**************************************************************/
+
+	// Runs update of state s and takes any transition.
+	// elapsed is the time spent in s (ms), advanced by the owner
+	// only while the machine runs and reset on transition.
+	// Returns the new current state.
+	uint8_t step(const State* t, uint8_t s, uint16_t& elapsed) {
+		const State& row = t[s];
+		outcome_t out = row.update();
+		uint8_t next = NONE;
+		if(out != OUT_STAY) next = row.next[out - 1];
+		else if(row.timeout && elapsed >= row.timeout)
+			next = row.fallback;
+		if(next == NONE) return s;
+		if(row.exit) row.exit();
+		elapsed = 0;
+		if(t[next].enter) t[next].enter();
+		return next;
+	}
+}
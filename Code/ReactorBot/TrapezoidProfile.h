@@ -0,0 +1,54 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// TrapezoidProfile.h
+// Class for online trapezoidal velocity profiles at a known period.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Generates a velocity each period that ramps up at aMax, cruises at
+// vMax, and ramps down at aMax to reach vEnd as the remaining
+// distance reaches zero. The remaining distance is passed in on every
+// update, so the profile follows a target that is measured (or
+// corrected) along the way rather than planned once. Units are up to
+// the owner as long as distance, velocity and time agree.
+class TrapezoidProfile {
+public:
+	TrapezoidProfile(float vMax, float aMax, float dt) {
+		this->vMax = vMax;
+		this->aMax = aMax;
+		this->dt = dt;
+	}
+
+	// Sets current velocity (call at start of motion)
+	void reset(float v = 0.0) {
+		this->v = v;
+	}
+
+	// Returns velocity for this period given distance remaining and
+	// velocity wanted at the end (both non-negative)
+	float update(float remaining, float vEnd = 0.0) {
+		float vStop = sqrt(vEnd * vEnd + 2.0 * aMax * fmax(remaining, 0.0));
+		float vNext = fmin(v + aMax * dt, fmin(vMax, vStop));
+		v = fmax(vNext, fmin(vEnd, v));
+		return v;
+	}
+
+	// Returns latest velocity
+	float velocity() {
+		return v;
+	}
+
+private:
+	float vMax;
+	float aMax;
+	float dt;
+	float v = 0.0;
+};
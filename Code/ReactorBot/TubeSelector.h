@@ -0,0 +1,85 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// TubeSelector.h
+// Namespace for ReactorBot storage and supply tube selection.
+// RBE-2001 A17 Team 7
+
+// Each refuel is reactor -> storage -> supply -> reactor, so the
+// storage tube is chosen together with the supply tube that follows
+// it. Candidate pairs are scored by total RoutePlanner travel time
+// from the robot's node, using the field's storage (bit set = full)
+// and supply (bit set = rod present) bitmasks. Handling time at the
+// tubes is the same for every pair and is left out.
+
+#pragma once
+#include "Arduino.h"
+#include "FieldPosition.h"
+#include "RoutePlanner.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace TubeSelector {
+
+	// Tube headings on arrival
+	const uint8_t HEADING_STORAGE = RoutePlanner::HEADING_IDX_U;
+	const uint8_t HEADING_SUPPLY = RoutePlanner::HEADING_IDX_D;
+
+	// Returns least time from storage tube i (1-4) through any
+	// supply tube with a rod to the reactor (tenths of s), or 0 if
+	// no supply tube has a rod.
+	uint16_t supplyTime(int i, const FieldPosition& reactor, uint8_t fuelData) {
+		uint16_t best = 0;
+		for(int j=1; j<=4; j++) {
+			if(!(fuelData & (1 << (j-1)))) continue;
+			uint16_t t =
+				RoutePlanner::time(STORAGE[i-1], HEADING_STORAGE, SUPPLY[j-1]) +
+				RoutePlanner::time(SUPPLY[j-1], HEADING_SUPPLY, reactor);
+			if(best == 0 || t < best) best = t;
+		}
+		return best;
+	}
+
+	// Returns supply tube (1-4) with least time from given node
+	// through the tube to the reactor, or 0 if none has a rod.
+	int pickSupply(const FieldPosition& from, uint8_t h,
+		const FieldPosition& reactor, uint8_t fuelData)
+	{
+		int best = 0;
+		uint16_t bestTime = 0;
+		for(int i=1; i<=4; i++) {
+			if(!(fuelData & (1 << (i-1)))) continue;
+			uint16_t t =
+				RoutePlanner::time(from, h, SUPPLY[i-1]) +
+				RoutePlanner::time(SUPPLY[i-1], HEADING_SUPPLY, reactor);
+			if(best == 0 || t < bestTime) {
+				best = i;
+				bestTime = t;
+			}
+		}
+		return best;
+	}
+
+	// Returns storage tube (1-4) starting the least-time storage,
+	// supply, reactor sequence from given node, or 0 if all are
+	// full. Supply is ignored if no tube has a rod.
+	int pickStorage(const FieldPosition& from, uint8_t h,
+		const FieldPosition& reactor, uint8_t storData, uint8_t fuelData)
+	{
+		int best = 0;
+		uint16_t bestTime = 0;
+		for(int i=1; i<=4; i++) {
+			if(storData & (1 << (i-1))) continue;
+			uint16_t t = RoutePlanner::time(from, h, STORAGE[i-1]) +
+				supplyTime(i, reactor, fuelData);
+			if(best == 0 || t < bestTime) {
+				best = i;
+				bestTime = t;
+			}
+		}
+		return best;
+	}
+}
@@ -12,8 +12,14 @@
 //**************************************************************/
 
 //!b Constructs ReactorComms through given hardware serial port.
-ReactorComms::ReactorComms(HardwareSerial& serial) {
+//!i Serial port of the HC-05
+//!i Team ID used as source of sent frames and accepted as destination
+ReactorComms::ReactorComms(HardwareSerial& serial, byte team) {
 	this->serial = &serial;
+	this->team = team;
+	encode(heartBeatFrame, HEART_BEAT_LEN, 0x07, 0x00);
+	encode(radAlertFrame[0], RAD_ALERT_LEN, 0x03, 0x2C); // Spent fuel rod
+	encode(radAlertFrame[1], RAD_ALERT_LEN, 0x03, 0xFF); // New fuel rod
 }
 
 //**************************************************************/
@@ -26,45 +32,14 @@ void ReactorComms::init() {
 }
 
 //!b Processes new message packets from reactor control module.
-//!d Ignores packets if:
-//!d - They are not from the reactor control module
-//!d - They are intended for another robot
-//!d - The have incorrect checksums
+//!d Parses at most COMMS_BYTES_PER_UPDATE bytes that are already
+//!d buffered and never waits on the serial port. Partial frames
+//!d are kept and completed on following calls.
 void ReactorComms::update() {
-	while(serial->available()) {
-		if(serial->read() == 0x5F) { // Search for start
-
-			// Read full message
-			checkSum = 0xFF;
-			byte len = read() + 1;
-			byte msg[len];
-			msg[0] = 0x5F;
-			msg[1] = len;
-			for(int i=2; i<len; i++) msg[i] = read();
-
-			// Check read conditions
-			if(checkSum == 0x00 // Checksum passed
-			  && msg[3] == 0x00 // Source is field
-			  //&& msg[4] == 0x07 // Destination is Team 7
-			){
-				// Check message type
-				switch(msg[2]) {
-					case 0x01: // Storage tube availability
-						storData = msg[5];
-						break;
-					case 0x02: // Supply tube availability
-						fuelData = msg[5];
-						break;
-					case 0x04: // Stop movement
-						robotEnabled = false;
-						break;
-					case 0x05: // Resume movement
-						robotEnabled = true;
-						break;
-				}
-			}
-		}
-	}
+	int n = serial->available();
+	if(n > COMMS_BYTES_PER_UPDATE) n = COMMS_BYTES_PER_UPDATE;
+	while(n--) parse(serial->read());
+	flush();
 }
 
 //!b Returns true if the robot is enabled by reactor control.
@@ -96,49 +71,193 @@ bool ReactorComms::supplyAvailable(int id) {
 	}
 }
 
-//!b Sends one heart-beat message to reactor control.
+//!b Returns storage tube bitmask (bit i set = tube i+1 full).
+byte ReactorComms::getStorageData() {
+	return storData;
+}
+
+//!b Returns supply tube bitmask (bit i set = tube i+1 full).
+byte ReactorComms::getSupplyData() {
+	return fuelData;
+}
+
+//!b Returns count of frames for this robot with valid checksums.
+uint32_t ReactorComms::getFramesAccepted() {
+	return framesAccepted;
+}
+
+//!b Returns count of frames dropped as not from reactor control
+//!b or not for this robot.
+uint32_t ReactorComms::getFramesDropped() {
+	return framesDropped;
+}
+
+//!b Returns count of frames for this robot with bad checksums.
+uint32_t ReactorComms::getChecksumErrors() {
+	return checksumErrors;
+}
+
+//!b Queues one heart-beat message to reactor control.
+//!d Heart-beats have the lowest priority. Only one heart-beat is
+//!d held at a time, so repeated calls before it is sent coalesce.
 void ReactorComms::sendHeartBeat() {
-	checkSum = 0xFF;
-	write(0x5F); // Start delimeter
-	write(0x05); // 5-byte message
-	write(0x07); // Heart beat type
-	write(0x07); // From robot 7
-	write(0x00); // To reactor control
-	write(checkSum);
+	heartBeatPending = true;
+	flush();
 }
 
-//!b Sends radiation alert to reactor control.
+//!b Queues radiation alert to reactor control.
 //!i True for new rod, false for spent rod
+//!d Alerts are sent ahead of heart-beats, but no more than once per
+//!d COMMS_ALERT_PERIOD. A newer alert replaces one still waiting.
 void ReactorComms::sendRadAlert(bool high) {
-	checkSum = 0xFF;
-	write(0x5F); // Start delimeter
-	write(0x06); // 6-byte message
-	write(0x03); // Radiation alert type
-	write(0x07); // From robot 7
-	write(0x00); // To reactor control
-	if(high)
-		write(0xFF); // New fuel rod
-	else
-		write(0x2C); // Spent fuel rod
-	write(checkSum);
+	radAlertHigh = high;
+	radAlertPending = true;
+	flush();
 }
 
 //**************************************************************/
 // PRIVATE METHOD DEFINITIONS
 //**************************************************************/
 
-//!d Reads 1 byte from the serial buffer and
-//!d decrements it from the checksum.
-byte ReactorComms::read() {
-	while(!serial->available());
-	byte b = serial->read();
-	checkSum -= b;
-	return b;
+//!d Advances the frame parser by 1 byte.
+//!d Frames with lengths outside [5, COMMS_FRAME_MAX) are dropped
+//!d as soon as the length byte is seen. Frames not from reactor
+//!d control or addressed to another robot are dropped once the
+//!d header is in, and the rest of their bytes are skipped without
+//!d buffering or checksumming.
+void ReactorComms::parse(byte b) {
+	switch(parseState) {
+
+		// Search for start
+		case PARSE_START:
+			if(b == 0x5F) {
+				checkSum = 0xFF;
+				parseState = PARSE_LENGTH;
+			}
+			break;
+
+		// Validate length
+		case PARSE_LENGTH:
+			if(b < 5 || b >= COMMS_FRAME_MAX) {
+				if(b != 0x5F) parseState = PARSE_START;
+				break;
+			}
+			frame[0] = 0x5F;
+			frame[1] = b;
+			frameLen = b + 1;
+			frameIdx = 2;
+			checkSum -= b;
+			parseState = PARSE_BODY;
+			break;
+
+		// Buffer remainder of frame
+		case PARSE_BODY:
+			frame[frameIdx++] = b;
+			checkSum -= b;
+			if(frameIdx == 5 && (frame[3] != COMMS_ADDR_FIELD
+				|| (frame[4] != team && frame[4] != COMMS_ADDR_FIELD)))
+			{
+				framesDropped++;
+				parseState = PARSE_SKIP;
+			} else if(frameIdx == frameLen) {
+				process();
+				parseState = PARSE_START;
+			}
+			break;
+
+		// Skip remainder of frame for another robot
+		case PARSE_SKIP:
+			if(++frameIdx == frameLen) parseState = PARSE_START;
+			break;
+	}
+}
+
+//!d Acts on a complete buffered frame addressed to this robot.
+//!d Ignores frames if:
+//!d - They have incorrect checksums
+//!d - They are too short for their message type
+void ReactorComms::process() {
+
+	// Check read conditions
+	if(checkSum != 0x00) {
+		checksumErrors++;
+		return;
+	}
+	framesAccepted++;
+
+	// Check message type
+	switch(frame[2]) {
+		case 0x01: // Storage tube availability
+			if(frameLen > 6) storData = frame[5];
+			break;
+		case 0x02: // Supply tube availability
+			if(frameLen > 6) fuelData = frame[5];
+			break;
+		case 0x04: // Stop movement
+			robotEnabled = false;
+			break;
+		case 0x05: // Resume movement
+			robotEnabled = true;
+			break;
+	}
+}
+
+//!d Encodes a robot message frame with optional 1-byte payload.
+//!d Frames of HEART_BEAT_LEN bytes carry no payload.
+void ReactorComms::encode(byte* frame, byte len, byte type, byte data) {
+	frame[0] = 0x5F;     // Start delimeter
+	frame[1] = len - 1;  // Message length
+	frame[2] = type;     // Message type
+	frame[3] = team;     // From this robot
+	frame[4] = COMMS_ADDR_FIELD; // To reactor control
+	if(len > HEART_BEAT_LEN) frame[5] = data;
+	byte sum = 0xFF;
+	for(int i=0; i<len-1; i++) sum -= frame[i];
+	frame[len-1] = sum;
 }
 
-//!d Writes 1 byte to the serial buffer and
-//!d decrements it from the checksum.
-void ReactorComms::write(byte b) {
-	serial->write(b);
-	checkSum -= b;
+//!d Copies a whole frame into the outbound ring.
+//!d Returns false without copying if the frame does not fit.
+bool ReactorComms::enqueue(const byte* frame, byte len) {
+	if(COMMS_TX_SIZE - txCount < len) return false;
+	for(int i=0; i<len; i++) {
+		txRing[txHead] = frame[i];
+		txHead = (txHead + 1) % COMMS_TX_SIZE;
+	}
+	txCount += len;
+	return true;
+}
+
+//!d Moves pending frames into the outbound ring by priority, then
+//!d writes as many bytes as the serial TX buffer has room for.
+void ReactorComms::flush() {
+
+	// Radiation alerts first (rate-limited)
+	unsigned long t = millis();
+	if(radAlertPending &&
+		(!radAlertSent || t - radAlertTime >= COMMS_ALERT_PERIOD) &&
+		enqueue(radAlertFrame[radAlertHigh], RAD_ALERT_LEN))
+	{
+		radAlertPending = false;
+		radAlertSent = true;
+		radAlertTime = t;
+	}
+
+	// Heart-beats only if a waiting alert would still fit
+	byte reserve = radAlertPending ? RAD_ALERT_LEN : 0;
+	if(heartBeatPending &&
+		COMMS_TX_SIZE - txCount >= HEART_BEAT_LEN + reserve &&
+		enqueue(heartBeatFrame, HEART_BEAT_LEN))
+	{
+		heartBeatPending = false;
+	}
+
+	// Drain without blocking
+	int n = serial->availableForWrite();
+	byte tail = (txHead + COMMS_TX_SIZE - txCount) % COMMS_TX_SIZE;
+	while(n-- > 0 && txCount > 0) {
+		serial->write(txRing[tail]);
+		tail = (tail + 1) % COMMS_TX_SIZE;
+		txCount--;
+	}
 }
@@ -8,8 +8,8 @@
 
 //!d This class utilizes the HC-05 Bluetooth serial bridge
 //!d module through any hardware serial port available on
-//!d any Arduino. The serial port is specified on object
-//!d construction.
+//!d any Arduino. The serial port and team ID are specified
+//!d on object construction.
 
 #pragma once
 #include "Arduino.h"
@@ -21,30 +21,79 @@
 const bool RADIATION_HI = true;
 const bool RADIATION_LO = false;
 
+const byte COMMS_TEAM_DEFAULT = 0x07; // Team ID of this robot
+const byte COMMS_ADDR_FIELD = 0x00;   // Reactor control (and broadcast)
+const byte COMMS_FRAME_MAX = 16;      // Max frame length (bytes)
+const int COMMS_BYTES_PER_UPDATE = 32; // Max bytes parsed per update
+const byte COMMS_TX_SIZE = 32;         // Outbound ring size (bytes)
+const unsigned long COMMS_ALERT_PERIOD = 200; // Min alert spacing (ms)
+
 //**************************************************************/
 // CLASS DECLARATION
 //**************************************************************/
 
 class ReactorComms {
 public:
-	ReactorComms(HardwareSerial& serial);
+	ReactorComms(HardwareSerial& serial, byte team = COMMS_TEAM_DEFAULT);
 	void init();
 
 	void update();
 	bool getRobotEnabled();
 	bool storageAvailable(int);
 	bool supplyAvailable(int);
+	byte getStorageData();
+	byte getSupplyData();
+
+	uint32_t getFramesAccepted();
+	uint32_t getFramesDropped();
+	uint32_t getChecksumErrors();
 
 	void sendHeartBeat();
 	void sendRadAlert(bool);
 private:
 	HardwareSerial* serial;
+	byte team;
 
 	bool robotEnabled = false;
 	byte storData = 0x00;
 	byte fuelData = 0x00;
 
+	// Incremental frame parser
+	enum parse_t {
+		PARSE_START,  // Searching for start delimeter
+		PARSE_LENGTH, // Waiting for length byte
+		PARSE_BODY,   // Reading remainder of frame
+		PARSE_SKIP,   // Discarding frame for another robot
+	} parseState = PARSE_START;
+	byte frame[COMMS_FRAME_MAX];
+	byte frameLen = 0;
+	byte frameIdx = 0;
+	void parse(byte);
+	void process();
+
+	// Frame counters
+	uint32_t framesAccepted = 0; // Addressed to us, checksum passed
+	uint32_t framesDropped = 0;  // Addressed elsewhere (not checksummed)
+	uint32_t checksumErrors = 0; // Addressed to us, checksum failed
+
 	byte checkSum = 0xFF;
-	byte read();
-	void write(byte);
+
+	// Pre-encoded outbound frames
+	static const byte HEART_BEAT_LEN = 6;
+	static const byte RAD_ALERT_LEN = 7;
+	byte heartBeatFrame[HEART_BEAT_LEN];
+	byte radAlertFrame[2][RAD_ALERT_LEN]; // Spent, new
+	void encode(byte* frame, byte len, byte type, byte data);
+
+	// Prioritized outbound queue
+	bool radAlertPending = false;
+	bool radAlertHigh = false;
+	bool radAlertSent = false;
+	unsigned long radAlertTime = 0;
+	bool heartBeatPending = false;
+	byte txRing[COMMS_TX_SIZE];
+	byte txHead = 0;
+	byte txCount = 0;
+	bool enqueue(const byte* frame, byte len);
+	void flush();
 };
@@ -0,0 +1,233 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Arduino.cpp
+// Host-side stand-in for the Arduino core API (Mega 2560).
+// RBE-2001 A17 Team 7
+
+#include "Arduino.h"
+#include <stdio.h>
+
+//**************************************************************/
+// HOST STATE DEFINITIONS
+//**************************************************************/
+
+namespace Host {
+
+	uint32_t clockUs = 0;
+	uint32_t quantumUs = 1;
+	plant_t plant = 0;
+	uint32_t plantStepUs = 1000;
+	uint16_t analogValue[NUM_PINS];
+	uint8_t digitalValue[NUM_PINS];
+	isr_t isr[NUM_INTERRUPTS];
+	volatile uint8_t portValue[NUM_PORTS];
+
+	// Time of last plant step (us)
+	uint32_t syncUs = 0;
+
+	// Advances the virtual clock and steps the plant.
+	void advance(uint32_t us) {
+		clockUs += us;
+		sync();
+	}
+
+	// Drives a digital input, firing its CHANGE interrupt if any.
+	void setPin(uint8_t pin, uint8_t level) {
+		if(pin >= NUM_PINS || digitalValue[pin] == level) return;
+		digitalValue[pin] = level;
+		uint8_t mask = digitalPinToBitMask(pin);
+		if(level) portValue[pin / 8] |= mask;
+		else portValue[pin / 8] &= ~mask;
+		int irq = digitalPinToInterrupt(pin);
+		if(irq >= 0 && isr[irq]) isr[irq]();
+	}
+
+	// Steps the plant if at least one plant step has elapsed.
+	void sync() {
+		uint32_t dt = clockUs - syncUs;
+		if(dt >= plantStepUs) {
+			syncUs = clockUs;
+			if(plant) plant(dt * 1e-6f);
+		}
+	}
+}
+
+//**************************************************************/
+// PIN FUNCTION DEFINITIONS
+//**************************************************************/
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	if(mode == INPUT_PULLUP && pin < Host::NUM_PINS)
+		Host::digitalValue[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+	if(pin < Host::NUM_PINS) Host::digitalValue[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+	Host::sync();
+	return (pin < Host::NUM_PINS) ? Host::digitalValue[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+	Host::sync();
+	return (pin < Host::NUM_PINS) ? Host::analogValue[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int val) {
+	if(pin < Host::NUM_PINS) Host::analogValue[pin] = val;
+}
+
+uint8_t digitalPinToPort(uint8_t pin) {
+	return pin / 8;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+	return 1 << (pin % 8);
+}
+
+volatile uint8_t* portInputRegister(uint8_t port) {
+	return &Host::portValue[port];
+}
+
+//**************************************************************/
+// TIME FUNCTION DEFINITIONS
+//**************************************************************/
+
+unsigned long micros() {
+	Host::clockUs += Host::quantumUs;
+	return Host::clockUs;
+}
+
+unsigned long millis() {
+	return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+	Host::advance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+	Host::advance(us);
+}
+
+//**************************************************************/
+// INTERRUPT FUNCTION DEFINITIONS
+//**************************************************************/
+
+// Mega 2560 external interrupt mapping
+int digitalPinToInterrupt(uint8_t pin) {
+	switch(pin) {
+		case 2: return 0;
+		case 3: return 1;
+		case 21: return 2;
+		case 20: return 3;
+		case 19: return 4;
+		case 18: return 5;
+		default: return -1;
+	}
+}
+
+void attachInterrupt(int irq, void (*isr)(), int /* mode */) {
+	if(irq >= 0 && irq < Host::NUM_INTERRUPTS) Host::isr[irq] = isr;
+}
+
+void detachInterrupt(int irq) {
+	if(irq >= 0 && irq < Host::NUM_INTERRUPTS) Host::isr[irq] = 0;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+//**************************************************************/
+// PRINT METHOD DEFINITIONS
+//**************************************************************/
+
+size_t Print::write(const uint8_t* buf, size_t len) {
+	size_t n = 0;
+	while(len--) n += write(*buf++);
+	return n;
+}
+
+size_t Print::print(const char* s) {
+	size_t n = 0;
+	while(*s) n += write((uint8_t)*s++);
+	return n;
+}
+
+size_t Print::print(char c) {
+	return write((uint8_t)c);
+}
+
+size_t Print::print(int n, int base) {
+	return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+	return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+	char buf[24];
+	if(base == HEX) snprintf(buf, sizeof(buf), "%lX", (unsigned long)n);
+	else snprintf(buf, sizeof(buf), "%ld", n);
+	return print(buf);
+}
+
+size_t Print::print(unsigned long n, int base) {
+	char buf[24];
+	snprintf(buf, sizeof(buf), (base == HEX) ? "%lX" : "%lu", n);
+	return print(buf);
+}
+
+size_t Print::print(double d, int digits) {
+	char buf[40];
+	snprintf(buf, sizeof(buf), "%.*f", digits, d);
+	return print(buf);
+}
+
+size_t Print::println() {
+	return print("\r\n");
+}
+
+//**************************************************************/
+// HARDWARE SERIAL DEFINITIONS
+//**************************************************************/
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+HardwareSerial Serial3;
+
+void HardwareSerial::begin(unsigned long /* baud */) {}
+
+int HardwareSerial::available() {
+	return (int)rx.size();
+}
+
+int HardwareSerial::read() {
+	if(rx.empty()) return -1;
+	uint8_t b = rx.front();
+	rx.pop_front();
+	return b;
+}
+
+int HardwareSerial::peek() {
+	return rx.empty() ? -1 : rx.front();
+}
+
+int HardwareSerial::availableForWrite() {
+	return 63;
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+	tx.push_back(b);
+	return 1;
+}
+
+void HardwareSerial::inject(const uint8_t* buf, size_t len) {
+	rx.insert(rx.end(), buf, buf + len);
+}
@@ -0,0 +1,156 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Arduino.h
+// Host-side stand-in for the Arduino core API (Mega 2560).
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <deque>
+#include <vector>
+#include "Host.h"
+
+//**************************************************************/
+// CONSTANT DEFINITIONS
+//**************************************************************/
+
+typedef uint8_t byte;
+
+#define F_CPU 16000000UL
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define F(s) (s)
+
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+#define B00000001 1
+#define B00000010 2
+#define B00000100 4
+#define B00001000 8
+
+const uint8_t LOW = 0;
+const uint8_t HIGH = 1;
+
+const uint8_t INPUT = 0;
+const uint8_t OUTPUT = 1;
+const uint8_t INPUT_PULLUP = 2;
+
+const int CHANGE = 1;
+const int FALLING = 2;
+const int RISING = 3;
+
+const int DEC = 10;
+const int HEX = 16;
+
+// Mega 2560 analog pins
+const uint8_t A0 = 54;
+const uint8_t A1 = 55;
+const uint8_t A2 = 56;
+const uint8_t A3 = 57;
+const uint8_t A4 = 58;
+const uint8_t A5 = 59;
+const uint8_t A6 = 60;
+const uint8_t A7 = 61;
+const uint8_t A8 = 62;
+const uint8_t A9 = 63;
+const uint8_t A10 = 64;
+const uint8_t A11 = 65;
+const uint8_t A12 = 66;
+const uint8_t A13 = 67;
+const uint8_t A14 = 68;
+const uint8_t A15 = 69;
+
+//**************************************************************/
+// FUNCTION DECLARATIONS
+//**************************************************************/
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portInputRegister(uint8_t port);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int irq, void (*isr)(), int mode);
+void detachInterrupt(int irq);
+void noInterrupts();
+void interrupts();
+
+//**************************************************************/
+// CLASS DECLARATIONS
+//**************************************************************/
+
+// Byte and text output (Arduino Print)
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t b) = 0;
+	virtual size_t write(const uint8_t* buf, size_t len);
+
+	size_t print(const char* s);
+	size_t print(char c);
+	size_t print(int n, int base = DEC);
+	size_t print(unsigned int n, int base = DEC);
+	size_t print(long n, int base = DEC);
+	size_t print(unsigned long n, int base = DEC);
+	size_t print(double d, int digits = 2);
+
+	size_t println();
+	template<typename T> size_t println(T val) {
+		size_t n = print(val);
+		return n + println();
+	}
+	template<typename T> size_t println(T val, int fmt) {
+		size_t n = print(val, fmt);
+		return n + println();
+	}
+};
+
+// Byte input stream (Arduino Stream)
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+// Simulated hardware serial port
+// Received bytes are injected by the host, transmitted bytes
+// are collected in tx for inspection.
+class HardwareSerial : public Stream {
+public:
+	void begin(unsigned long baud);
+	int available();
+	int read();
+	int peek();
+	int availableForWrite();
+	size_t write(uint8_t b);
+	using Print::write;
+
+	// Host access
+	void inject(const uint8_t* buf, size_t len);
+	std::deque<uint8_t> rx;
+	std::vector<uint8_t> tx;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
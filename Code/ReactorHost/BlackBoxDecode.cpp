@@ -0,0 +1,117 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// BlackBoxDecode.cpp
+// Host decoder of ReactorBot black box dumps.
+// RBE-2001 A17 Team 7
+
+// Scans a raw capture of the USB serial port for black box dumps and
+// prints their records as CSV in SI units. Text printed by other
+// console commands between dumps is skipped. Wrapped times and wheel
+// angles are unwrapped within each dump, so times count from the
+// first record's millis() modulo 65.536 s. Dumps with an unknown
+// version or a bad checksum are reported on stderr and skipped.
+// Usage: blackboxdecode [capture_file] (default stdin)
+
+#include "BlackBox.h"
+#include <stdio.h>
+#include <vector>
+
+//**************************************************************/
+// FUNCTION DEFINITIONS
+//**************************************************************/
+
+// Returns x unwrapped to the 16-bit value nearest last
+long unwrap(long last, uint16_t x) {
+	return last + (int16_t)(uint16_t)(x - (uint16_t)last);
+}
+
+// Prints records of one dump as CSV rows
+void printDump(int id, const std::vector<BlackBox::Record>& recs) {
+	long t = 0, l = 0, r = 0;
+	for(size_t i=0; i<recs.size(); i++) {
+		const BlackBox::Record& rec = recs[i];
+		if(i == 0) {
+			t = rec.time;
+			l = rec.angleL;
+			r = rec.angleR;
+		} else {
+			t = unwrap(t, rec.time);
+			l = unwrap(l, rec.angleL);
+			r = unwrap(r, rec.angleR);
+		}
+		printf("%d,%u,%.3f,%u,%u,%c,%u,%u,%.4f,%.3f,%.2f,%.2f,%.2f,%u,%.1f,%.1f,%.1f\n",
+			id, (unsigned)i, t * 1e-3, rec.state,
+			rec.mode & 0x03, (rec.mode & 0x04) ? 'B' : 'A',
+			(rec.mode >> 3) & 0x01, (rec.mode >> 4) & 0x03,
+			rec.heading * (TWO_PI / 65536.0),
+			rec.gZ * 1e-3,
+			rec.line * 1e-2,
+			l * 1e-2,
+			r * 1e-2,
+			rec.arm,
+			rec.uHeading * 0.1,
+			rec.uRate * 0.1,
+			rec.uArm * 0.1);
+	}
+}
+
+//**************************************************************/
+// MAIN FUNCTION
+//**************************************************************/
+
+int main(int argc, char** argv) {
+
+	// Read capture
+	FILE* in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+	if(!in) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+	std::vector<uint8_t> buf;
+	int c;
+	while((c = fgetc(in)) != EOF) buf.push_back(c);
+	if(in != stdin) fclose(in);
+
+	// Scan for dumps
+	printf("dump,record,time_s,state,task,reactor,enabled,radiation,"
+		"heading_rad,gz_rad_s,line_cm,angle_l_rad,angle_r_rad,arm_adc,"
+		"u_heading_v,u_rate_v,u_arm_v\n");
+	int dumps = 0;
+	size_t i = 0;
+	while(i + BlackBox::HEADER_LEN <= buf.size()) {
+		const uint8_t* h = &buf[i];
+		if(h[0] != BlackBox::MAGIC[0] || h[1] != BlackBox::MAGIC[1]
+			|| h[2] != BlackBox::MAGIC[2])
+		{
+			i++;
+			continue;
+		}
+		if(h[3] != BlackBox::VERSION || h[4] != sizeof(BlackBox::Record)) {
+			fprintf(stderr, "offset %zu: unsupported version %u size %u\n",
+				i, h[3], h[4]);
+			i++;
+			continue;
+		}
+		size_t len = BlackBox::HEADER_LEN + h[5] * sizeof(BlackBox::Record) + 1;
+		if(i + len > buf.size()) {
+			fprintf(stderr, "offset %zu: truncated dump\n", i);
+			break;
+		}
+		uint8_t sum = 0;
+		for(size_t k=sizeof(BlackBox::MAGIC); k<len; k++) sum += h[k];
+		if(sum != 0) {
+			fprintf(stderr, "offset %zu: bad checksum\n", i);
+			i++;
+			continue;
+		}
+		std::vector<BlackBox::Record> recs(h[5]);
+		memcpy(recs.data(), h + BlackBox::HEADER_LEN,
+			recs.size() * sizeof(BlackBox::Record));
+		printDump(dumps++, recs);
+		i += len;
+	}
+	fprintf(stderr, "%d dumps decoded\n", dumps);
+	return 0;
+}
@@ -0,0 +1,49 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Bno055.h
+// Host-side stand-in for the ArduinoLibs Bno055 class.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CONSTANT DEFINITIONS
+//**************************************************************/
+
+// Chip mounting orientations (dot location)
+enum bno055_orientation_t {
+	tlf, trf, brf, blf,
+	tlb, trb, brb, blb,
+};
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+class Bno055 {
+public:
+	Bno055(bno055_orientation_t /* orientation */) {}
+
+	bool begin() {
+		return true;
+	}
+
+	// Returns compass heading (rad, 0 to 2*PI)
+	float heading() {
+		Host::sync();
+		return simHeading;
+	}
+
+	// Returns angular velocity about z (rad/s, CCW positive)
+	float gZ() {
+		Host::sync();
+		return simGz;
+	}
+
+	// Host access
+	float simHeading = 0.0;
+	float simGz = 0.0;
+};
@@ -0,0 +1,319 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// CommsBench.cpp
+// Host throughput and fuzz benchmark of ReactorComms.
+// RBE-2001 A17 Team 7
+
+// Feeds ReactorComms a random byte stream through a host serial port
+// and calls update() once per simulated comms period. The stream mixes
+// valid frames of every message type with bit-flipped, truncated and
+// interleaved frames, bad lengths, frames from other sources, and line
+// noise. Each period a random number of bytes arrives, up to the
+// 64-byte RX buffer of the Mega's hardware serial ports.
+//
+// Every byte update() consumes is also fed to a reference parser,
+// which buffers whole frames and applies them by the protocol rules.
+// storData, fuelData, robotEnabled and the frame counters must match
+// the reference after every update(), so the data can only change on
+// complete frames for this robot with a good checksum. A corrupted
+// frame that still passes the 8-bit checksum is counted as a
+// collision, not a failure.
+//
+// Prints host ns per update() and per byte, valid frames per host
+// second, and the most bytes parsed in one update().
+// Usage: commsbench [frames] [max_arrival] [seed]
+// Exits with status 1 on any mismatch with the reference.
+
+#include "ReactorComms.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <set>
+#include <vector>
+
+//**************************************************************/
+// STREAM GENERATOR
+//**************************************************************/
+
+typedef std::vector<uint8_t> bytes_t;
+
+const size_t RX_SIZE = 64; // Hardware serial RX buffer (bytes)
+const uint8_t TEAM = 0x07; // Team ID of robot under test
+
+// Returns random integer in [0, n)
+int randInt(int n) {
+	return rand() % n;
+}
+
+// Returns encoded frame with given type, source, destination, data
+bytes_t encode(uint8_t type, uint8_t src, uint8_t dst, const bytes_t& data) {
+	uint8_t len = 5 + data.size();
+	bytes_t f(len + 1);
+	f[0] = 0x5F;
+	f[1] = len;
+	f[2] = type;
+	f[3] = src;
+	f[4] = dst;
+	for(size_t i=0; i<data.size(); i++) f[5 + i] = data[i];
+	uint8_t sum = 0;
+	for(int i=1; i<len; i++) sum += f[i];
+	f[len] = 0xFF - sum;
+	return f;
+}
+
+// Returns random frame from reactor control (all message types)
+bytes_t randomFrame() {
+	static const uint8_t TYPES[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	uint8_t type = TYPES[randInt(sizeof(TYPES))];
+	bytes_t data;
+	int n = (type <= 0x03) ? 1 : 0;
+	if(randInt(8) == 0) n = randInt(COMMS_FRAME_MAX - 5); // Odd length
+	for(int i=0; i<n; i++) data.push_back(randInt(256));
+	uint8_t dst = randInt(4) ? TEAM : (randInt(2) ? 0x00 : randInt(256));
+	return encode(type, 0x00, dst, data);
+}
+
+// Stream statistics
+struct StreamStats {
+	long valid = 0;       // Intact frames
+	long corrupted = 0;   // Bit flips
+	long truncated = 0;   // Cut short (next frame follows)
+	long interleaved = 0; // Another frame spliced inside
+	long badLength = 0;   // Length outside parser limits
+	long foreign = 0;     // Intact, source not reactor control
+	long noise = 0;       // Random bytes
+};
+
+// Appends one random stream event to s. Intact frames from reactor
+// control are added to valid.
+void generate(std::deque<uint8_t>& s, std::set<bytes_t>& valid, StreamStats& st) {
+	bytes_t f = randomFrame();
+	switch(randInt(10)) {
+		case 0: { // Bit flip
+			f[1 + randInt(f.size() - 1)] ^= 1 << randInt(8);
+			st.corrupted++;
+			break;
+		}
+		case 1: { // Truncated
+			f.resize(1 + randInt(f.size() - 1));
+			st.truncated++;
+			break;
+		}
+		case 2: { // Interleaved
+			bytes_t g = randomFrame();
+			f.insert(f.begin() + 1 + randInt(f.size() - 1), g.begin(), g.end());
+			st.interleaved++;
+			break;
+		}
+		case 3: { // Bad length
+			f[1] = randInt(2) ? randInt(5) : COMMS_FRAME_MAX + randInt(240);
+			st.badLength++;
+			break;
+		}
+		case 4: { // Other source
+			f[3] = 1 + randInt(255);
+			f = encode(f[2], f[3], f[4], bytes_t(f.begin() + 5, f.end() - 1));
+			st.foreign++;
+			break;
+		}
+		case 5: { // Line noise (with start bytes)
+			f.clear();
+			for(int i=randInt(8); i>0; i--)
+				f.push_back(randInt(4) ? randInt(256) : 0x5F);
+			st.noise += f.size();
+			break;
+		}
+		default:
+			valid.insert(f);
+			st.valid++;
+			break;
+	}
+	s.insert(s.end(), f.begin(), f.end());
+}
+
+//**************************************************************/
+// REFERENCE PARSER
+//**************************************************************/
+
+// Buffers the byte stream and applies whole frames. A frame is a
+// start byte, a length n in [5, COMMS_FRAME_MAX), and n more bytes.
+// A start byte in the length position begins a new frame. Frames
+// not from reactor control (source 0x00), or not addressed to TEAM
+// or broadcast (0x00), are counted as dropped once their 5 header
+// bytes are in, then discarded whole. The rest are accepted if the
+// sum of n and the n bytes is 0xFF. Accepted frames set tube data
+// (types 0x01 and 0x02, if they carry data) and stop or resume the
+// robot (types 0x04 and 0x05).
+struct Reference {
+	bytes_t buf;
+	uint8_t storData = 0x00;
+	uint8_t fuelData = 0x00;
+	bool robotEnabled = false;
+	uint32_t framesAccepted = 0;
+	uint32_t framesDropped = 0;
+	uint32_t checksumErrors = 0;
+	std::vector<bytes_t> accepted; // Accepted frames since last take
+	bool dropped = false; // Frame at front of buf counted as dropped
+
+	void feed(uint8_t b) {
+		buf.push_back(b);
+		while(!buf.empty()) {
+			if(buf[0] != 0x5F) {
+				buf.erase(buf.begin());
+				continue;
+			}
+			if(buf.size() < 2) return;
+			uint8_t len = buf[1];
+			if(len < 5 || len >= COMMS_FRAME_MAX) {
+				buf.erase(buf.begin(), buf.begin() + ((len == 0x5F) ? 1 : 2));
+				continue;
+			}
+			if(buf.size() >= 5 && !dropped
+				&& (buf[3] != 0x00 || (buf[4] != TEAM && buf[4] != 0x00)))
+			{
+				framesDropped++;
+				dropped = true;
+			}
+			if(buf.size() < (size_t)len + 1) return;
+			bytes_t f(buf.begin(), buf.begin() + len + 1);
+			buf.erase(buf.begin(), buf.begin() + len + 1);
+			if(dropped) {
+				dropped = false;
+				continue;
+			}
+			uint8_t sum = 0;
+			for(int i=1; i<=len; i++) sum += f[i];
+			if(sum == 0xFF) apply(f);
+			else checksumErrors++;
+		}
+	}
+
+	void apply(const bytes_t& f) {
+		accepted.push_back(f);
+		framesAccepted++;
+		bool data = f[1] >= 6;
+		switch(f[2]) {
+			case 0x01: if(data) storData = f[5]; break;
+			case 0x02: if(data) fuelData = f[5]; break;
+			case 0x04: robotEnabled = false; break;
+			case 0x05: robotEnabled = true; break;
+			default: break;
+		}
+	}
+};
+
+//**************************************************************/
+// MAIN FUNCTION
+//**************************************************************/
+
+int main(int argc, char** argv) {
+
+	// Parse arguments
+	long frames = (argc > 1) ? atol(argv[1]) : 2000000;
+	int maxArrival = (argc > 2) ? atoi(argv[2]) : 48;
+	srand((argc > 3) ? atoi(argv[3]) : 1);
+
+	// Device under test and reference
+	HardwareSerial port;
+	ReactorComms com(port, TEAM);
+	com.init();
+	Reference ref;
+
+	// Stream
+	std::deque<uint8_t> stream;
+	std::set<bytes_t> valid;
+	StreamStats st;
+
+	// Statistics
+	typedef std::chrono::steady_clock clock;
+	double totalNs = 0.0, maxNs = 0.0;
+	long updates = 0, bytesParsed = 0, maxBytes = 0, maxBacklog = 0;
+	long collisions = 0, mismatches = 0;
+	std::vector<float> samples;
+
+	// Benchmark loop
+	long generated = 0;
+	while(generated < frames || !stream.empty()) {
+
+		// Bytes arriving this period
+		while(generated < frames && stream.size() < RX_SIZE) {
+			generate(stream, valid, st);
+			generated++;
+		}
+		int arrive = randInt(maxArrival + 1);
+		while(arrive-- > 0 && !stream.empty() && port.rx.size() < RX_SIZE) {
+			port.rx.push_back(stream.front());
+			stream.pop_front();
+		}
+		maxBacklog = std::max(maxBacklog, (long)port.rx.size());
+
+		// Timed update
+		std::deque<uint8_t> before = port.rx;
+		clock::time_point t0 = clock::now();
+		com.update();
+		clock::time_point t1 = clock::now();
+		double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+		totalNs += ns;
+		maxNs = std::max(maxNs, ns);
+		samples.push_back(ns);
+		port.tx.clear();
+		Host::advance(10000);
+		updates++;
+
+		// Reference check
+		long n = before.size() - port.rx.size();
+		for(long i=0; i<n; i++) ref.feed(before[i]);
+		bytesParsed += n;
+		maxBytes = std::max(maxBytes, n);
+		for(size_t i=0; i<ref.accepted.size(); i++)
+			if(!valid.count(ref.accepted[i])) collisions++;
+		ref.accepted.clear();
+		if(com.getStorageData() != ref.storData
+			|| com.getSupplyData() != ref.fuelData
+			|| com.getRobotEnabled() != ref.robotEnabled
+			|| com.getFramesAccepted() != ref.framesAccepted
+			|| com.getFramesDropped() != ref.framesDropped
+			|| com.getChecksumErrors() != ref.checksumErrors)
+		{
+			if(mismatches++ < 10)
+				printf("mismatch at update %ld: stor %02X/%02X fuel %02X/%02X "
+					"en %d/%d acc %u/%u drop %u/%u err %u/%u\n",
+					updates, com.getStorageData(), ref.storData,
+					com.getSupplyData(), ref.fuelData,
+					com.getRobotEnabled(), ref.robotEnabled,
+					com.getFramesAccepted(), ref.framesAccepted,
+					com.getFramesDropped(), ref.framesDropped,
+					com.getChecksumErrors(), ref.checksumErrors);
+		}
+	}
+
+	// Summary
+	std::sort(samples.begin(), samples.end());
+	printf("frames generated   %ld\n", generated);
+	printf("  valid            %ld\n", st.valid);
+	printf("  corrupted        %ld\n", st.corrupted);
+	printf("  truncated        %ld\n", st.truncated);
+	printf("  interleaved      %ld\n", st.interleaved);
+	printf("  bad length       %ld\n", st.badLength);
+	printf("  other source     %ld\n", st.foreign);
+	printf("  noise bytes      %ld\n", st.noise);
+	printf("frames accepted    %u\n", com.getFramesAccepted());
+	printf("frames dropped     %u\n", com.getFramesDropped());
+	printf("checksum errors    %u\n", com.getChecksumErrors());
+	printf("checksum collisions %ld\n", collisions);
+	printf("updates            %ld\n", updates);
+	printf("bytes parsed       %ld\n", bytesParsed);
+	printf("max bytes/update   %ld (limit %d)\n", maxBytes, COMMS_BYTES_PER_UPDATE);
+	printf("max RX backlog     %ld (buffer %zu)\n", maxBacklog, RX_SIZE);
+	printf("mean ns/update     %.1f\n", totalNs / updates);
+	printf("p99 ns/update      %.1f\n", samples[samples.size() * 99 / 100]);
+	printf("max ns/update      %.1f\n", maxNs);
+	printf("ns/byte            %.1f\n", totalNs / bytesParsed);
+	printf("valid frames/s     %.0f\n", st.valid / (totalNs * 1e-9));
+	printf("mismatches         %ld\n", mismatches);
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// DcMotor.h
+// Host-side stand-in for the ArduinoLibs DcMotor class.
+// RBE-2001 A17 Team 7
+
+// Encoders are decoded by QuadEncoder, so only the H-bridge
+// interface is modeled here.
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+class DcMotor {
+public:
+	DcMotor(
+		float vTerminal,
+		uint8_t pinEnable,
+		uint8_t /* pinForward */,
+		uint8_t /* pinReverse */,
+		uint8_t /* pinEncoderA */,
+		uint8_t /* pinEncoderB */,
+		float /* encoderCpr */) {
+		this->vTerminal = vTerminal;
+		this->pinEnable = pinEnable;
+	}
+
+	void setup() {
+		pinMode(pinEnable, OUTPUT);
+	}
+
+	void enable() {
+		enabled = true;
+		digitalWrite(pinEnable, HIGH);
+	}
+
+	void disable() {
+		enabled = false;
+		digitalWrite(pinEnable, LOW);
+	}
+
+	void setVoltage(float v) {
+		if(v > vTerminal) v = vTerminal;
+		if(v < -vTerminal) v = -vTerminal;
+		voltage = v;
+		braked = false;
+	}
+
+	void brake() {
+		voltage = 0.0;
+		braked = true;
+	}
+
+
+	// Host access
+	// Voltage applied across the terminals (V)
+	float appliedVoltage() const {
+		return enabled ? voltage : 0.0;
+	}
+	bool enabled = false;
+	bool braked = false;
+	float voltage = 0.0;
+private:
+	float vTerminal;
+	uint8_t pinEnable;
+};
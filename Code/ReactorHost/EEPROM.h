@@ -0,0 +1,51 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// EEPROM.h
+// Host-side stand-in for the Arduino EEPROM library.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// 4 KB of erased (0xFF) memory like the Mega's, kept for the life
+// of the host process.
+class EEPROMClass {
+public:
+	EEPROMClass() {
+		memset(data, 0xFF, sizeof(data));
+	}
+	uint8_t read(int idx) {
+		return data[idx];
+	}
+	void write(int idx, uint8_t val) {
+		data[idx] = val;
+		writes++;
+	}
+	void update(int idx, uint8_t val) {
+		if(data[idx] != val) write(idx, val);
+	}
+	template<typename T> T& get(int idx, T& t) {
+		memcpy(&t, data + idx, sizeof(T));
+		return t;
+	}
+	template<typename T> const T& put(int idx, const T& t) {
+		const uint8_t* p = (const uint8_t*)&t;
+		for(size_t i=0; i<sizeof(T); i++) update(idx + i, p[i]);
+		return t;
+	}
+	uint16_t length() {
+		return sizeof(data);
+	}
+
+	// Host access
+	uint8_t data[4096];
+	uint32_t writes = 0; // Bytes written (cells wear out)
+};
+
+static EEPROMClass EEPROM;
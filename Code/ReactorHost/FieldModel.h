@@ -0,0 +1,263 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// FieldModel.h
+// Namespace for the simulated field and robot plant.
+// RBE-2001 A17 Team 7
+
+// Kinematic model of the robot on the reactor field. It is
+// stepped by the host HAL clock and writes the simulated sensor
+// values (line array, arm pot, IMU, limit switches, Bluetooth)
+// that the ReactorBot namespaces read through the HAL. Host programs
+// may add Gaussian noise to the analog and IMU readings.
+
+#pragma once
+#include "StateMachine.h"
+
+//**************************************************************/
+// NAMESPACE DEFINITION
+//**************************************************************/
+
+namespace FieldModel {
+
+	// Field Geometry (m)
+	// Intersection (i, j) is located at (i*GRID, j*GRID).
+	const float GRID = 0.30;
+	const float LINE_WIDTH = 0.019;
+	const float REACTOR_A_FACE = 0.55 * GRID;
+	const float REACTOR_B_FACE = 6.45 * GRID;
+	const float TUBE_FACE = 0.90 * GRID;
+
+	// Robot Geometry (m)
+	const float WHEEL_RADIUS = 0.035;
+	const float TRACK_WIDTH = 0.20;
+	const float SENSOR_OFFSET = PoseEstimator::SENSOR_OFFSET;
+	const float SENSOR_PITCH = LineFollower::SENSOR_PITCH * 0.01;
+	const float BUMPER_OFFSET = 0.12;
+
+	// Actuator Models
+	// Deliberately offset from the robot's own models (DriveModel.h
+	// and Arm.h), so feedforward and identification are tested against
+	// a plant they do not match exactly.
+	const float WHEEL_GAIN = 1.35;  // Wheel speed per volt ((rad/s)/V)
+	const float WHEEL_TAU = 0.065;  // Wheel time constant (s)
+	const float WHEEL_STATIC = 0.4; // Voltage lost to friction (V)
+	const float ARM_GAIN = 34.0;           // Pot rate per volt ((ADC/s)/V)
+	const float ARM_GRAVITY = 1.8;         // Holding voltage when horizontal (V)
+	const float ARM_POT_HORIZONTAL = 135.0; // Pot reading, arm forward horizontal (ADC)
+	const float ARM_POT_PER_RAD = 182.0;    // Pot scale (ADC/rad)
+
+	// Sensor Models
+	const uint16_t ADC_WHITE = 50;
+	const uint16_t ADC_BLACK = 900;
+	const float BROADCAST_PERIOD = 1.0; // Field tube broadcasts (s)
+
+	// Sensor noise (rms, set by host programs, default none)
+	float lineNoise = 0.0;    // Line sensors (ADC)
+	float potNoise = 0.0;     // Arm potentiometer (ADC)
+	float gyroNoise = 0.0;    // IMU yaw rate (rad/s)
+	float headingNoise = 0.0; // IMU heading (rad)
+
+	// Plant state
+	float x, y, th; // Robot VTC pose (m, m, compass rad)
+	float wL, wR;   // Wheel speeds (rad/s)
+	float angL, angR; // Wheel angles (rad)
+	int32_t stepsL, stepsR; // Encoder steps emitted
+	float armPot;   // Arm potentiometer (ADC)
+	float h0;       // IMU heading offset (rad)
+	float broadcastTime; // Time since last broadcast (s)
+
+	// Field tube state (ReactorComms bit layout)
+	byte storData = 0x00; // Occupied storage tubes
+	byte fuelData = 0x0F; // Full supply tubes
+
+	// Wraps angle to [0, 2*PI)
+	float wrap(float a) {
+		a = fmod(a, TWO_PI);
+		return (a < 0.0) ? (a + TWO_PI) : a;
+	}
+
+	// Returns normally distributed sample with given rms (0 = none)
+	float noise(float rms) {
+		if(rms == 0.0) return 0.0;
+		float u1 = (rand() + 1.0) / (RAND_MAX + 1.0);
+		float u2 = rand() / (RAND_MAX + 1.0);
+		return rms * sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2);
+	}
+
+	// Returns wheel voltage left after static friction (V)
+	float friction(float v) {
+		if(v > WHEEL_STATIC) return v - WHEEL_STATIC;
+		if(v < -WHEEL_STATIC) return v + WHEEL_STATIC;
+		return 0.0;
+	}
+
+	// Returns true if given field point is on a line
+	bool onLine(float px, float py) {
+		const float hw = LINE_WIDTH / 2.0;
+		if(fabs(py) < hw && px > REACTOR_A_FACE && px < REACTOR_B_FACE)
+			return true;
+		for(int i=1; i<=6; i++) {
+			if(fabs(px - i * GRID) < hw) {
+				float yMax = (i == 1 || i == 6) ? 0.05 : GRID;
+				if(fabs(py) < yMax) return true;
+			}
+		}
+		return false;
+	}
+
+	// Returns true if robot bumper at given pose is inside a wall
+	bool blocked(float px, float py, float pth) {
+		float bx = px + BUMPER_OFFSET * sin(pth);
+		float by = py + BUMPER_OFFSET * cos(pth);
+		if(fabs(by) < 0.1 && (bx < REACTOR_A_FACE || bx > REACTOR_B_FACE))
+			return true;
+		for(int i=2; i<=5; i++)
+			if(fabs(bx - i * GRID) < 0.05 && fabs(by) > TUBE_FACE)
+				return true;
+		return false;
+	}
+
+	// Queues a field message on the Bluetooth serial port
+	void sendFrame(byte type, byte dst, const byte* data, int n) {
+		byte frame[16];
+		byte len = 5 + n;
+		frame[0] = 0x5F;
+		frame[1] = len;
+		frame[2] = type;
+		frame[3] = 0x00; // From reactor control
+		frame[4] = dst;
+		for(int i=0; i<n; i++) frame[5 + i] = data[i];
+		byte sum = 0;
+		for(int i=1; i<len; i++) sum += frame[i];
+		frame[len] = 0xFF - sum;
+		Serial3.inject(frame, len + 1);
+	}
+
+	// Broadcasts storage and supply tube availability
+	void broadcast() {
+		sendFrame(0x01, 0x00, &storData, 1);
+		sendFrame(0x02, 0x00, &fuelData, 1);
+	}
+
+	// Sends resume or stop movement to the robot
+	void setEnabled(bool enabled) {
+		const byte none = 0x00;
+		sendFrame(enabled ? 0x05 : 0x04, 0x07, &none, 0);
+	}
+
+	// Emits quadrature edges on encoder pins up to wheel angle.
+	// Channel A leads B when driving forward.
+	void encode(float angle, int32_t& steps, uint8_t pinA, uint8_t pinB) {
+		static const uint8_t GRAY[4] = { 0, 2, 3, 1 }; // AB sequence
+		int32_t target = (int32_t)floor(angle * MotorL::ENCODER_CPR / TWO_PI);
+		while(steps != target) {
+			steps += (target > steps) ? 1 : -1;
+			uint8_t ab = GRAY[steps & 3];
+			Host::setPin(pinA, ab >> 1);
+			Host::setPin(pinB, ab & 1);
+		}
+	}
+
+	// Updates simulated sensor readings from plant state
+	void writeSensors() {
+
+		// Line sensor array
+		float bx = x + SENSOR_OFFSET * sin(th);
+		float by = y + SENSOR_OFFSET * cos(th);
+		for(int i=0; i<8; i++) {
+			float d = (3.5 - i) * SENSOR_PITCH;
+			float sx = bx - d * cos(th);
+			float sy = by + d * sin(th);
+			float adc = (onLine(sx, sy) ? ADC_BLACK : ADC_WHITE) + noise(lineNoise);
+			Host::analogValue[LineFollower::PINS[i]] = constrain(adc, 0.0, 1023.0);
+		}
+
+		// Arm potentiometer
+		float pot = armPot + noise(potNoise);
+		Host::analogValue[Arm::PIN_ANGLE_POT] = constrain(pot, 0.0, 1023.0);
+
+		// IMU
+		ImuSampler::imu.simHeading = wrap(th + h0 + noise(headingNoise));
+		ImuSampler::imu.simGz =
+			-WHEEL_RADIUS * (wL - wR) / TRACK_WIDTH + noise(gyroNoise);
+
+		// Limit switches (active low)
+		float fx = x + BUMPER_OFFSET * sin(th);
+		float fy = y + BUMPER_OFFSET * cos(th);
+		const float touch = 0.002;
+		bool atReactor = fabs(fy) < 0.1 && (
+			fx < REACTOR_A_FACE + touch ||
+			fx > REACTOR_B_FACE - touch);
+		bool atTube = false;
+		for(int i=2; i<=5; i++)
+			if(fabs(fx - i * GRID) < 0.05 && fabs(fy) > TUBE_FACE - touch)
+				atTube = true;
+		Host::digitalValue[PIN_SWITCH_REACTOR] = atReactor ? LOW : HIGH;
+		Host::digitalValue[PIN_SWITCH_TUBE] = atTube ? LOW : HIGH;
+	}
+
+	// Advances plant by dt seconds (Host::plant callback)
+	void step(float dt) {
+
+		// Wheel dynamics
+		float a = dt / (WHEEL_TAU + dt);
+		float vL = MotorL::motor.appliedVoltage();
+		float vR = MotorR::motor.appliedVoltage();
+		wL += a * (WHEEL_GAIN * friction(vL) - wL);
+		wR += a * (WHEEL_GAIN * friction(vR) - wR);
+		if(MotorL::motor.braked) wL = 0.0;
+		if(MotorR::motor.braked) wR = 0.0;
+		angL += wL * dt;
+		angR += wR * dt;
+		encode(angL, stepsL, MotorL::PIN_ENCODER_A, MotorL::PIN_ENCODER_B);
+		encode(angR, stepsR, MotorR::PIN_ENCODER_A, MotorR::PIN_ENCODER_B);
+
+		// Differential drive kinematics
+		float v = WHEEL_RADIUS * (wL + wR) / 2.0;
+		float thNew = th + WHEEL_RADIUS * (wL - wR) / TRACK_WIDTH * dt;
+		float xNew = x + v * sin(thNew) * dt;
+		float yNew = y + v * cos(thNew) * dt;
+		if(!blocked(xNew, yNew, thNew)) {
+			x = xNew;
+			y = yNew;
+		}
+		th = thNew;
+
+		// Arm
+		// The braked gearmotor holds the arm against gravity.
+		if(!Arm::motor.braked) {
+			float armAngle = (armPot - ARM_POT_HORIZONTAL) / ARM_POT_PER_RAD;
+			armPot += ARM_GAIN * (Arm::motor.appliedVoltage()
+				- ARM_GRAVITY * cos(armAngle)) * dt;
+		}
+		if(armPot < 0.0) armPot = 0.0;
+		if(armPot > 1023.0) armPot = 1023.0;
+
+		// Field broadcasts
+		broadcastTime += dt;
+		if(broadcastTime >= BROADCAST_PERIOD) {
+			broadcastTime = 0.0;
+			broadcast();
+		}
+
+		writeSensors();
+	}
+
+	// Places robot at its start pose and enables it
+	void reset(float heading0 = 0.0) {
+		x = 2 * GRID;
+		y = 0.0;
+		th = 0.0;
+		wL = wR = 0.0;
+		angL = angR = 0.0;
+		stepsL = stepsR = 0;
+		armPot = 300.0;
+		h0 = heading0;
+		broadcastTime = 0.0;
+		writeSensors();
+		setEnabled(true);
+		broadcast();
+	}
+}
@@ -0,0 +1,53 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Host.h
+// Namespace for the simulated hardware behind the host HAL.
+// RBE-2001 A17 Team 7
+
+// The host HAL replaces the Arduino core and ArduinoLibs device
+// classes so the ReactorBot namespaces compile natively. All
+// simulated hardware state (clock, pins, interrupts) lives here
+// and is driven by a plant model installed by the host program.
+
+#pragma once
+#include <stdint.h>
+
+//**************************************************************/
+// NAMESPACE DECLARATION
+//**************************************************************/
+
+namespace Host {
+
+	// Virtual clock (us)
+	// Every clock read advances time by quantumUs so busy-waits
+	// in robot code terminate deterministically.
+	extern uint32_t clockUs;
+	extern uint32_t quantumUs;
+	void advance(uint32_t us);
+
+	// Plant model (called with elapsed time in seconds)
+	// Stepped once the clock has advanced by plantStepUs.
+	typedef void (*plant_t)(float dt);
+	extern plant_t plant;
+	extern uint32_t plantStepUs;
+	void sync();
+
+	// Simulated pin states
+	const int NUM_PINS = 70;
+	extern uint16_t analogValue[NUM_PINS];
+	extern uint8_t digitalValue[NUM_PINS];
+
+	// Simulated input ports (pin p is bit p % 8 of port p / 8)
+	const int NUM_PORTS = NUM_PINS / 8 + 1;
+	extern volatile uint8_t portValue[NUM_PORTS];
+
+	// External interrupt handlers
+	const int NUM_INTERRUPTS = 6;
+	typedef void (*isr_t)();
+	extern isr_t isr[NUM_INTERRUPTS];
+
+	// Drives a digital input, firing its CHANGE interrupt if any
+	void setPin(uint8_t pin, uint8_t level);
+}
@@ -0,0 +1,33 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Led.h
+// Host-side stand-in for the ArduinoLibs Led class.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+class Led {
+public:
+	Led(uint8_t pin) {
+		this->pin = pin;
+	}
+	void init() {
+		pinMode(pin, OUTPUT);
+		off();
+	}
+	void on() {
+		digitalWrite(pin, HIGH);
+	}
+	void off() {
+		digitalWrite(pin, LOW);
+	}
+private:
+	uint8_t pin;
+};
@@ -0,0 +1,30 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// LimitSwitch.h
+// Host-side stand-in for the ArduinoLibs LimitSwitch class.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Switch is wired to ground with the internal pullup enabled.
+class LimitSwitch {
+public:
+	LimitSwitch(uint8_t pin) {
+		this->pin = pin;
+	}
+	void setup() {
+		pinMode(pin, INPUT_PULLUP);
+	}
+	bool pressed() {
+		return digitalRead(pin) == LOW;
+	}
+private:
+	uint8_t pin;
+};
@@ -0,0 +1,108 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// LoopBench.cpp
+// Host benchmark of robotLoop() per-iteration cost.
+// RBE-2001 A17 Team 7
+
+// Runs robotSetup() and the robotLoop() scheduler against the host
+// HAL and the simulated field, timing every pass which runs a task
+// on the host CPU. Control task passes are broken down by state.
+// Usage: loopbench [iterations] [period_us] [max_mean_ns]
+// Exits with status 1 if the mean cost exceeds max_mean_ns.
+
+#include "StateMachine.h"
+#include "FieldModel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+//**************************************************************/
+// FUNCTION DEFINITIONS
+//**************************************************************/
+
+// Returns index of task run since run counts were recorded in runs,
+// or -1 if none ran (robotLoop() runs at most one)
+int taskRun(const uint32_t* runs) {
+	for(uint8_t i=0; i<Scheduler::numTasks; i++)
+		if(Scheduler::tasks[i].runs != runs[i]) return i;
+	return -1;
+}
+
+//**************************************************************/
+// MAIN FUNCTION
+//**************************************************************/
+
+int main(int argc, char** argv) {
+
+	// Parse arguments
+	long iterations = (argc > 1) ? atol(argv[1]) : 1000000;
+	uint32_t periodUs = (argc > 2) ? atol(argv[2]) : 250;
+	double maxMeanNs = (argc > 3) ? atof(argv[3]) : 0.0;
+
+	// Initialize plant and robot
+	FieldModel::reset();
+	Host::plant = FieldModel::step;
+	robotSetup();
+
+	// Per-state statistics
+	long count[NUM_STATES] = {0};
+	double sumNs[NUM_STATES] = {0};
+	double maxNs[NUM_STATES] = {0};
+	std::vector<float> samples;
+	samples.reserve(iterations);
+	long refuels = 0;
+
+	// Benchmark loop
+	typedef std::chrono::steady_clock clock;
+	for(long i=0; i<iterations; i++) {
+		state_t s = state;
+		uint32_t runs[Scheduler::MAX_TASKS];
+		for(uint8_t j=0; j<Scheduler::numTasks; j++)
+			runs[j] = Scheduler::tasks[j].runs;
+		clock::time_point t0 = clock::now();
+		robotLoop();
+		clock::time_point t1 = clock::now();
+		int ran = taskRun(runs);
+		Serial3.tx.clear();
+		Host::advance(periodUs);
+		if(ran < 0) continue;
+		double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+		samples.push_back(ns);
+		if(ran != 0) continue;
+		count[s]++;
+		sumNs[s] += ns;
+		if(ns > maxNs[s]) maxNs[s] = ns;
+		if(s == STATE_SET_TASK && task == TASK_EMPTY_REACTOR) refuels++;
+	}
+
+	// Summary statistics
+	double total = 0.0;
+	for(size_t i=0; i<samples.size(); i++) total += samples[i];
+	double mean = total / samples.size();
+	std::sort(samples.begin(), samples.end());
+	printf("iterations      %ld\n", iterations);
+	printf("task passes     %ld\n", (long)samples.size());
+	printf("simulated time  %.1f s\n", iterations * periodUs * 1e-6);
+	printf("refuel cycles   %ld\n", refuels);
+	printf("mean            %.1f ns\n", mean);
+	printf("p50             %.1f ns\n", samples[samples.size() / 2]);
+	printf("p99             %.1f ns\n", samples[samples.size() * 99 / 100]);
+	printf("max             %.1f ns\n", samples.back());
+	printf("\n%-18s %10s %10s %10s\n", "state", "count", "mean ns", "max ns");
+	for(int s=0; s<NUM_STATES; s++) {
+		if(!count[s]) continue;
+		printf("%-18s %10ld %10.1f %10.1f\n",
+			STATE_NAMES[s], count[s], sumNs[s] / count[s], maxNs[s]);
+	}
+
+	// Regression check
+	if(maxMeanNs > 0.0 && mean > maxMeanNs) {
+		printf("\nFAIL: mean %.1f ns exceeds %.1f ns\n", mean, maxMeanNs);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,294 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// MissionSim.cpp
+// Host Monte Carlo simulator of full ReactorBot missions.
+// RBE-2001 A17 Team 7
+
+// Runs many full missions of the state machine against the simulated
+// field and reports the distribution of refuel cycle times, so that
+// strategy and tuning changes can be compared statistically. Each
+// mission starts at a random IMU heading offset with random storage
+// and supply availability, which changes one tube at a time at random
+// times. Sensors get Gaussian noise, and reactor control stops the
+// robot for a random time at random intervals. A mission fails if it
+// does not finish its refuels within CYCLE_LIMIT of enabled time per
+// refuel. Cycle and mission times count enabled time only, so they do
+// not depend on how long the robot was stopped.
+//
+// The robot code keeps its state in globals which robotSetup() does
+// not fully reinitialize, so every mission runs in its own forked
+// process. Up to one process per CPU core runs at a time, and each
+// sends its result back over a pipe. Mission i is seeded with
+// seed + i, so any mission can be replayed on its own.
+// Usage: missionsim [missions] [refuels] [seed] [workers]
+
+#include "StateMachine.h"
+#include "FieldModel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+//**************************************************************/
+// SIMULATION SETTINGS
+//**************************************************************/
+
+const uint32_t PERIOD_US = 250;  // Host loop period (us)
+const uint8_t MAX_REFUELS = 16;  // Refuels per mission limit
+const float CYCLE_LIMIT = 120.0; // Enabled time allowed per refuel (s)
+
+// Sensor noise (rms)
+const float LINE_NOISE = 40.0;     // Line sensors (ADC)
+const float POT_NOISE = 2.0;       // Arm potentiometer (ADC)
+const float GYRO_NOISE = 0.02;     // IMU yaw rate (rad/s)
+const float HEADING_NOISE = 0.005; // IMU heading (rad)
+
+// Random events (mean intervals are exponential)
+const float STOP_INTERVAL = 60.0;  // Mean time between stops (s)
+const float STOP_MIN = 0.5;        // Shortest stop (s)
+const float STOP_MAX = 5.0;        // Longest stop (s)
+const float TUBE_INTERVAL = 20.0;  // Mean time between tube changes (s)
+
+//**************************************************************/
+// MISSION
+//**************************************************************/
+
+// Result sent back by a mission process
+struct Result {
+	uint32_t mission;           // Mission index
+	uint8_t refuels;            // Refuels completed
+	uint8_t stops;              // Times stopped by reactor control
+	uint16_t timeouts[NUM_STATES]; // State timeouts
+	float cycles[MAX_REFUELS];  // Enabled time of each refuel (s)
+	float time;                 // Enabled mission time (s)
+};
+
+// Returns uniform random number in [0, 1)
+float uniform() {
+	return rand() / (RAND_MAX + 1.0);
+}
+
+// Returns exponential random interval with given mean
+float interval(float mean) {
+	return -mean * log(1.0 - uniform());
+}
+
+// Returns tube bitmask with at least one bit of the given value
+byte randomTubes(bool need) {
+	byte data;
+	do data = rand() & 0x0F;
+	while(need ? (data == 0x00) : (data == 0x0F));
+	return data;
+}
+
+// Flips one random tube of bitmask unless it would leave none with
+// the given bit value
+byte changeTube(byte data, bool need) {
+	byte next = data ^ (1 << (rand() % 4));
+	return (need ? (next == 0x00) : (next == 0x0F)) ? data : next;
+}
+
+// Runs one mission of given number of refuels
+Result runMission(uint32_t mission, uint8_t refuels, unsigned seed) {
+	Result r;
+	memset(&r, 0, sizeof(r));
+	r.mission = mission;
+	srand(seed);
+
+	// Randomized field and sensors
+	FieldModel::storData = randomTubes(false); // Some storage tube empty
+	FieldModel::fuelData = randomTubes(true);  // Some supply tube full
+	FieldModel::lineNoise = LINE_NOISE;
+	FieldModel::potNoise = POT_NOISE;
+	FieldModel::gyroNoise = GYRO_NOISE;
+	FieldModel::headingNoise = HEADING_NOISE;
+	FieldModel::reset(TWO_PI * uniform());
+	Host::plant = FieldModel::step;
+	robotSetup();
+
+	// Event times (s)
+	const float dt = PERIOD_US * 1e-6;
+	float t = 0.0;
+	float tEnabled = 0.0;
+	float tCycle = 0.0;
+	float nextStop = interval(STOP_INTERVAL);
+	float resume = 0.0;
+	float nextTube = interval(TUBE_INTERVAL);
+	bool stopped = false;
+	float limit = refuels * CYCLE_LIMIT;
+
+	while(r.refuels < refuels && tEnabled < limit) {
+
+		// Reactor control stops and resumes
+		if(!stopped && t >= nextStop) {
+			FieldModel::setEnabled(false);
+			stopped = true;
+			resume = t + STOP_MIN + (STOP_MAX - STOP_MIN) * uniform();
+			if(r.stops < 0xFF) r.stops++;
+		} else if(stopped && t >= resume) {
+			FieldModel::setEnabled(true);
+			stopped = false;
+			nextStop = t + interval(STOP_INTERVAL);
+		}
+
+		// Tube availability changes (seen at the next broadcast)
+		if(t >= nextTube) {
+			if(rand() & 1)
+				FieldModel::storData = changeTube(FieldModel::storData, false);
+			else
+				FieldModel::fuelData = changeTube(FieldModel::fuelData, true);
+			nextTube = t + interval(TUBE_INTERVAL);
+		}
+
+		// Robot loop pass
+		state_t s = state;
+		uint16_t elapsed = stateElapsed;
+		robotLoop();
+		Serial.tx.clear(); // Black box dumps and console
+		Serial3.tx.clear();
+		Host::advance(PERIOD_US);
+		t += dt;
+		if(Bluetooth::com.getRobotEnabled()) {
+			tEnabled += dt;
+			tCycle += dt;
+		}
+
+		// Timeouts and completed refuels
+		if(state == s) continue;
+		uint16_t timeout = STATE_TABLE[s].timeout;
+		if(timeout && elapsed + PERIOD_CONTROL / 1000 >= timeout)
+			r.timeouts[s]++;
+		if(s == STATE_SET_TASK && task == TASK_EMPTY_REACTOR) {
+			r.cycles[r.refuels++] = tCycle;
+			tCycle = 0.0;
+		}
+	}
+	r.time = tEnabled;
+	return r;
+}
+
+//**************************************************************/
+// STATISTICS
+//**************************************************************/
+
+// Prints mean, p50, p95 and max of samples (s)
+void printStats(const char* name, std::vector<float>& x) {
+	if(x.empty()) {
+		printf("%-16s %9s\n", name, "-");
+		return;
+	}
+	std::sort(x.begin(), x.end());
+	double sum = 0.0;
+	for(size_t i=0; i<x.size(); i++) sum += x[i];
+	printf("%-16s %9.2f %9.2f %9.2f %9.2f\n", name, sum / x.size(),
+		x[x.size() / 2], x[x.size() * 95 / 100], x.back());
+}
+
+//**************************************************************/
+// MAIN FUNCTION
+//**************************************************************/
+
+int main(int argc, char** argv) {
+
+	// Parse arguments
+	long missions = (argc > 1) ? atol(argv[1]) : 1000;
+	int refuels = (argc > 2) ? atoi(argv[2]) : 2;
+	unsigned seed = (argc > 3) ? strtoul(argv[3], nullptr, 0) : 1;
+	long workers = (argc > 4) ? atol(argv[4]) : sysconf(_SC_NPROCESSORS_ONLN);
+	refuels = constrain(refuels, 1, (int)MAX_REFUELS);
+	if(workers < 1) workers = 1;
+
+	// Run missions in worker processes
+	std::vector<Result> results;
+	std::vector<long> crashed;
+	std::map<pid_t, std::pair<long, int>> running; // Mission and pipe
+	long next = 0;
+	while(next < missions || !running.empty()) {
+
+		// Start missions up to one per worker
+		if(next < missions && (long)running.size() < workers) {
+			int fd[2];
+			if(pipe(fd) != 0) {
+				perror("pipe");
+				return 1;
+			}
+			fflush(stdout);
+			pid_t pid = fork();
+			if(pid < 0) {
+				perror("fork");
+				return 1;
+			}
+			if(pid == 0) {
+				close(fd[0]);
+				Result r = runMission(next, refuels, seed + next);
+				ssize_t n = write(fd[1], &r, sizeof(r));
+				_exit(n == sizeof(r) ? 0 : 1);
+			}
+			close(fd[1]);
+			running[pid] = std::make_pair(next++, fd[0]);
+			continue;
+		}
+
+		// Collect a finished mission
+		int status;
+		pid_t pid = wait(&status);
+		if(pid < 0) {
+			perror("wait");
+			return 1;
+		}
+		std::pair<long, int> m = running[pid];
+		running.erase(pid);
+		Result r;
+		if(read(m.second, &r, sizeof(r)) == sizeof(r)) results.push_back(r);
+		else crashed.push_back(m.first);
+		close(m.second);
+	}
+
+	// Cycle and mission statistics
+	std::vector<float> cycles, times;
+	std::vector<long> failed;
+	long timeouts[NUM_STATES] = {0};
+	long stops = 0;
+	for(size_t i=0; i<results.size(); i++) {
+		const Result& r = results[i];
+		for(int j=0; j<r.refuels; j++) cycles.push_back(r.cycles[j]);
+		if(r.refuels == refuels) times.push_back(r.time);
+		else failed.push_back(r.mission);
+		for(int s=0; s<NUM_STATES; s++) timeouts[s] += r.timeouts[s];
+		stops += r.stops;
+	}
+	std::sort(failed.begin(), failed.end());
+	std::sort(crashed.begin(), crashed.end());
+
+	// Report
+	printf("missions        %ld\n", missions);
+	printf("refuels         %d per mission\n", refuels);
+	printf("workers         %ld\n", workers);
+	printf("seed            %u\n", seed);
+	printf("completed       %ld\n", (long)times.size());
+	printf("failed          %ld\n", (long)failed.size());
+	printf("crashed         %ld\n", (long)crashed.size());
+	printf("stops           %ld\n", stops);
+	printf("\n%-16s %9s %9s %9s %9s\n", "time (s)", "mean", "p50", "p95", "max");
+	printStats("refuel cycle", cycles);
+	printStats("mission", times);
+	bool header = false;
+	for(int s=0; s<NUM_STATES; s++) {
+		if(!timeouts[s]) continue;
+		if(!header) printf("\n%-18s %10s\n", "state", "timeouts");
+		header = true;
+		printf("%-18s %10ld\n", STATE_NAMES[s], timeouts[s]);
+	}
+	for(size_t i=0; i<failed.size(); i++)
+		printf("%sfailed mission %ld (seed %lu)\n", i ? "" : "\n",
+			failed[i], (unsigned long)(seed + failed[i]));
+	for(size_t i=0; i<crashed.size(); i++)
+		printf("%scrashed mission %ld (seed %lu)\n", i ? "" : "\n",
+			crashed[i], (unsigned long)(seed + crashed[i]));
+	return (failed.empty() && crashed.empty()) ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// PidBench.cpp
+// Host comparison of FixedPid against the float PidController.
+// RBE-2001 A17 Team 7
+
+// Runs both controllers with the gains of each ReactorBot loop on
+// the same error sequence at the control period and reports the
+// host time per update and the largest output difference while
+// both outputs are well inside saturation (the two controllers use
+// different anti-windup schemes). Cycle counts on the Mega are
+// printed by the 'f' serial console command.
+// Usage: pidbench [updates]
+
+#include "GyroDrive.h"
+#include "LineFollower.h"
+#include "Arm.h"
+#include "PidController.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+//**************************************************************/
+// BENCHMARK
+//**************************************************************/
+
+// Controller gains and limits
+struct Loop {
+	const char* name;
+	float kp, ki, kd;
+	float uMax;
+	float errMax;
+};
+
+const Loop LOOPS[] = {
+	{ "heading",
+		GyroDrive::ANGLE_KP, GyroDrive::ANGLE_KI, GyroDrive::ANGLE_KD,
+		GyroDrive::ANGLE_VMAX, GyroDrive::ANGLE_ERR_MAX },
+	{ "yaw rate",
+		GyroDrive::VEL_KP, GyroDrive::VEL_KI, GyroDrive::VEL_KD,
+		GyroDrive::VEL_VMAX, GyroDrive::VEL_ERR_MAX },
+	{ "line",
+		LineFollower::KP, LineFollower::KI, LineFollower::KD,
+		LineFollower::ANGULAR_SPEED, LineFollower::ERR_MAX },
+	{ "arm",
+		Arm::PID_KP, Arm::PID_KI, Arm::PID_KD,
+		Arm::TERMINAL_VOLTAGE, Arm::PID_ERR_MAX },
+};
+
+// Returns a decaying, noisy error sequence over [-errMax, errMax]
+float error(long i, float errMax) {
+	float decay = exp(-0.002 * (i % 4000));
+	float noise = (rand() / (float)RAND_MAX - 0.5) * 0.02;
+	return errMax * (0.5 * decay * cos(0.01 * i) + noise);
+}
+
+// Runs one controller and returns host ns per update
+template<typename Pid>
+double run(Pid& pid, const float* err, long n, float* out) {
+	typedef std::chrono::steady_clock clock;
+	clock::time_point t0 = clock::now();
+	for(long i=0; i<n; i++) {
+		out[i] = pid.update(err[i]);
+		Host::clockUs += Scheduler::CONTROL_PERIOD;
+	}
+	clock::time_point t1 = clock::now();
+	return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+//**************************************************************/
+// MAIN FUNCTION
+//**************************************************************/
+
+int main(int argc, char** argv) {
+	long n = (argc > 1) ? atol(argv[1]) : 200000;
+	float* err = new float[n];
+	float* uFloat = new float[n];
+	float* uFixed = new float[n];
+	Host::quantumUs = 0;
+
+	printf("%-10s %12s %12s %12s\n",
+		"loop", "float ns", "fixed ns", "max |du|");
+	for(unsigned l=0; l<sizeof(LOOPS)/sizeof(LOOPS[0]); l++) {
+		const Loop& c = LOOPS[l];
+		PidController floatPid(c.kp, c.ki, c.kd, -c.uMax, +c.uMax);
+		FixedPid fixedPid(c.kp, c.ki, c.kd, -c.uMax, +c.uMax,
+			c.errMax, Scheduler::CONTROL_DT);
+		srand(1);
+		for(long i=0; i<n; i++) err[i] = error(i, c.errMax);
+		Host::advance(Scheduler::CONTROL_PERIOD);
+		double nsFloat = run(floatPid, err, n, uFloat);
+		double nsFixed = run(fixedPid, err, n, uFixed);
+		float du = 0.0;
+		for(long i=0; i<n; i++)
+			if(fabs(uFloat[i]) < 0.5 * c.uMax && fabs(uFixed[i]) < 0.5 * c.uMax)
+				du = fmax(du, fabs(uFloat[i] - uFixed[i]));
+		printf("%-10s %12.1f %12.1f %12.5f\n", c.name, nsFloat, nsFixed, du);
+	}
+	delete[] err;
+	delete[] uFloat;
+	delete[] uFixed;
+	return 0;
+}
@@ -0,0 +1,77 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// PidController.h
+// Host-side stand-in for the ArduinoLibs PidController class.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+// Float PID with output saturation and integrator clamping.
+// Timing is measured with micros(). The controller resets if it
+// has not been updated for resetTime seconds.
+class PidController {
+public:
+	PidController(
+		float kp, float ki, float kd,
+		float uMin, float uMax,
+		float resetTime = 1.0e9) {
+		this->kp = kp;
+		this->ki = ki;
+		this->kd = kd;
+		this->uMin = uMin;
+		this->uMax = uMax;
+		this->resetTime = resetTime;
+	}
+
+	// Returns controller output for given error
+	float update(float error) {
+		unsigned long t = micros();
+		float dt = (t - tPrev) * 1e-6f;
+		tPrev = t;
+		if(!running || dt > resetTime || dt <= 0.0) {
+			running = true;
+			errInt = 0.0;
+			errDer = 0.0;
+		} else {
+			errDer = (error - errPrev) / dt;
+			errInt += error * dt;
+		}
+		errPrev = error;
+		float u = kp * error + ki * errInt + kd * errDer;
+		if(u > uMax || u < uMin) {
+			if(running && dt > 0.0 && dt <= resetTime)
+				errInt -= error * dt; // Anti-windup
+			u = (u > uMax) ? uMax : uMin;
+		}
+		return u;
+	}
+
+	// Returns true if error and error rate are within tolerance
+	bool isStabilized(float errTol, float derTol) {
+		return running
+			&& fabs(errPrev) < errTol
+			&& fabs(errDer) < derTol;
+	}
+
+	void reset() {
+		running = false;
+		errInt = 0.0;
+		errDer = 0.0;
+	}
+private:
+	float kp, ki, kd;
+	float uMin, uMax;
+	float resetTime;
+	bool running = false;
+	unsigned long tPrev = 0;
+	float errPrev = 0.0;
+	float errInt = 0.0;
+	float errDer = 0.0;
+};
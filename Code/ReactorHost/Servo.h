@@ -0,0 +1,35 @@
+//**************************************************************/
+// TITLE
+//**************************************************************/
+
+// Servo.h
+// Host-side stand-in for the Arduino Servo library.
+// RBE-2001 A17 Team 7
+
+#pragma once
+#include "Arduino.h"
+
+//**************************************************************/
+// CLASS DEFINITION
+//**************************************************************/
+
+class Servo {
+public:
+	uint8_t attach(int pin) {
+		this->pin = pin;
+		return 0;
+	}
+	void write(int angle) {
+		this->angle = angle;
+	}
+	int read() {
+		return angle;
+	}
+	bool attached() {
+		return pin >= 0;
+	}
+
+	// Host access
+	int pin = -1;
+	int angle = 90; // Commanded angle (deg)
+};